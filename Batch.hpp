@@ -0,0 +1,129 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <iostream>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "position.hpp"
+#include "Solver.hpp"
+
+namespace GameSolver { namespace Connect4 {
+
+  // 배치 모드
+  // 한 줄에 하나씩 착수 순서 문자열(예 "4453")을 읽어 "점수 노드수 마이크로초" 한 줄을 출력한다.
+  // 잘못된 착수 순서는 "invalid" 를 출력한다. 빈 줄은 건너뛴다.
+  //
+  // 입력 파싱은 별도의 스레드가 미리 해서 큐에 쌓아두고, 호출한 스레드는 탐색만 한다.
+  // 솔버(와 트랜스포지션 테이블)는 모든 줄에서 재사용한다.
+  // 출력은 대기 중인 입력이 없을 때만 flush 해서 대량 처리 시 터미널/파이프 부담을 줄인다.
+  // Solver 는 보드 크기별 솔버(BasicSolver<W, H>)이고, 착수 순서도 그 크기의 보드로 해석한다.
+  template<class Solver>
+  class BasicBatch {
+    public:
+
+    typedef typename Solver::Position Position;
+
+    BasicBatch(Solver &solver, bool weak): solver(solver), weak(weak), eof{false} {}
+
+    // 입력이 끝날 때까지 처리하고 처리한 줄 수를 리턴한다.
+    unsigned long long run(std::istream &in, std::ostream &out)
+    {
+      std::thread reader([this, &in]() { read(in); });
+      unsigned long long count = 0;
+      Item item;
+      while(pop(item)) {
+        count++;
+        if(!item.valid) {
+          out << "invalid\n";
+        } else {
+          auto start = std::chrono::steady_clock::now();
+          int score = solver.solve(item.P, weak);
+          auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+          out << score << ' ' << solver.getNodeCount() << ' ' << micros << '\n';
+        }
+        if(waitingForInput()) out.flush();
+      }
+      out.flush();
+      reader.join();
+      return count;
+    }
+
+    private:
+
+    struct Item {
+      Position P;
+      bool valid;
+    };
+
+    // 큐가 너무 커지지 않게 제한한다.
+    static const size_t MAX_QUEUE = 4096;
+
+    Solver &solver;
+    bool weak;
+    std::deque<Item> queue;
+    bool eof;
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+
+    void read(std::istream &in)
+    {
+      std::string line;
+      while(std::getline(in, line)) {
+        size_t b = line.find_first_not_of(" \t\r");
+        if(b == std::string::npos) continue;
+        size_t e = line.find_last_not_of(" \t\r");
+        std::string seq = line.substr(b, e - b + 1);
+
+        Item item;
+        item.valid = item.P.play(seq) == seq.size();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]() { return queue.size() < MAX_QUEUE; });
+        queue.push_back(item);
+        notEmpty.notify_one();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      eof = true;
+      notEmpty.notify_one();
+    }
+
+    bool pop(Item &item)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      notEmpty.wait(lock, [this]() { return eof || !queue.empty(); });
+      if(queue.empty()) return false;
+      item = queue.front();
+      queue.pop_front();
+      notFull.notify_one();
+      return true;
+    }
+
+    // 큐가 비어 있고 입력이 아직 끝나지 않았는지 여부
+    bool waitingForInput()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return queue.empty() && !eof;
+    }
+  };
+
+  typedef BasicBatch<Solver> Batch;
+
+}}
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef BULK_EVAL_HPP
+#define BULK_EVAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "position.hpp"
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8 && defined(__x86_64__)
+#include <immintrin.h>
+#define BULK_EVAL_X86 1
+#endif
+
+namespace GameSolver { namespace Connect4 {
+
+  // 서로 독립적인 포지션 여러 개를 한꺼번에 평가하는 함수 모음. 대량 분석과 데이터셋 생성용.
+  // 포지션은 (Position::positionBits(), Position::maskBits()) 쌍을 두 배열로 나누어 넘긴다.
+  //
+  // compute_winning_position 은 상수 쉬프트와 AND/OR 로만 이루어져 있으므로
+  // 64비트 레인 4개(AVX2) 또는 8개(AVX-512)에서 그대로 동시에 계산할 수 있다.
+  // 계산식은 kernel 템플릿 하나에 GCC 벡터 확장으로 작성하고, 레인 수가 다른 세 경로가 이를 공유한다.
+  // 실행 시 CPU 를 확인해 가장 넓은 경로를 고르므로 -march 없이 빌드해도 된다.
+  // 레인 수로 나누어떨어지지 않는 나머지 포지션은 스칼라 경로로 처리한다.
+  class BulkEval {
+    public:
+
+    enum Isa { SCALAR, AVX2, AVX512 };
+
+    // 이 CPU 에서 쓸 수 있는 가장 넓은 경로
+    static Isa detect()
+    {
+#ifdef BULK_EVAL_X86
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) return AVX512;
+      if(__builtin_cpu_supports("avx2")) return AVX2;
+#endif
+      return SCALAR;
+    }
+
+    // 현재 사용 중인 경로
+    static Isa isa()
+    {
+      return current();
+    }
+
+    // 사용할 경로를 지정한다. 벤치마크에서 경로별 성능을 비교할 때 사용한다.
+    // CPU 가 지원하지 않는 경로는 지정되지 않고 false 를 리턴한다.
+    static bool setIsa(Isa i)
+    {
+      if(i > detect()) return false;
+      current() = i;
+      return true;
+    }
+
+    static const char* isaName(Isa i)
+    {
+      return i == AVX512 ? "avx512" : i == AVX2 ? "avx2" : "scalar";
+    }
+
+    // out[i] = 포지션 i 에서 현재 착수할 플레이어가 다음 수로 4목을 만드는 빈 칸들
+    static void winningPositions(const uint64_t *position, const uint64_t *mask, uint64_t *out, size_t n)
+    {
+      size_t i = 0;
+#ifdef BULK_EVAL_X86
+      if(current() == AVX512) i = winning512(position, mask, out, n);
+      else if(current() == AVX2) i = winning256(position, mask, out, n);
+#endif
+      for(; i < n; i++) winning(position[i], mask[i], out[i]);
+    }
+
+    // out[i] = 포지션 i 의 Position::possibleNonLosingMoves()
+    // 바로 이길 수 있는 포지션(canWinNext)은 미리 걸러서 넘겨야 한다.
+    static void nonLosingMoves(const uint64_t *position, const uint64_t *mask, uint64_t *out, size_t n)
+    {
+      size_t i = 0;
+#ifdef BULK_EVAL_X86
+      if(current() == AVX512) i = nonLosing512(position, mask, out, n);
+      else if(current() == AVX2) i = nonLosing256(position, mask, out, n);
+#endif
+      for(; i < n; i++) nonLosing(position[i], mask[i], out[i]);
+    }
+
+    // out[i] = 포지션 i 에서 move[i] (착수 비트 하나) 의 Position::moveScore()
+    static void moveScores(const uint64_t *position, const uint64_t *mask, const uint64_t *move, int *out, size_t n)
+    {
+      size_t i = 0;
+#ifdef BULK_EVAL_X86
+      if(current() == AVX512) i = scores512(position, mask, move, out, n);
+      else if(current() == AVX2) i = scores256(position, mask, move, out, n);
+#endif
+      for(; i < n; i++) {
+        uint64_t w;
+        winning(position[i] | move[i], mask[i], w);
+        out[i] = __builtin_popcountll(w);
+      }
+    }
+
+    private:
+
+    static Isa& current()
+    {
+      static Isa i = detect();
+      return i;
+    }
+
+    // 아래 템플릿은 벡터 타입을 값으로 주고받지 않고 참조로 넘긴다.
+    // 기본 타깃에서 AVX 벡터를 값으로 넘기면 호출 규약이 달라진다는 경고(-Wpsabi)가 나기 때문이다.
+
+    // x 가 0 이 아닌 레인은 모든 비트를 1로, 0 인 레인은 0 으로 만든다. 스칼라와 벡터에 같은 식을 쓴다.
+    template<class V>
+    static inline __attribute__((always_inline)) void nonZero(const V &x, V &out)
+    {
+      out = -((x | -x) >> 63);
+    }
+
+    // Position::compute_winning_position 과 같은 계산. V 는 uint64_t 또는 64비트 레인의 벡터 타입.
+    template<class V>
+    static inline __attribute__((always_inline)) void winning(const V &position, const V &mask, V &out)
+    {
+      const int H = Position::HEIGHT;
+      V r = (position << 1) & (position << 2) & (position << 3);
+
+      V p = (position << (H+1)) & (position << 2*(H+1));
+      r |= p & (position << 3*(H+1));
+      r |= p & (position >> (H+1));
+      p = (position >> (H+1)) & (position >> 2*(H+1));
+      r |= p & (position << (H+1));
+      r |= p & (position >> 3*(H+1));
+
+      p = (position << H) & (position << 2*H);
+      r |= p & (position << 3*H);
+      r |= p & (position >> H);
+      p = (position >> H) & (position >> 2*H);
+      r |= p & (position << H);
+      r |= p & (position >> 3*H);
+
+      p = (position << (H+2)) & (position << 2*(H+2));
+      r |= p & (position << 3*(H+2));
+      r |= p & (position >> (H+2));
+      p = (position >> (H+2)) & (position >> 2*(H+2));
+      r |= p & (position << (H+2));
+      r |= p & (position >> 3*(H+2));
+
+      out = r & (Position::board_mask ^ mask);
+    }
+
+    // Position::possibleNonLosingMoves 와 같은 계산. 분기 대신 레인 마스크로 강제 착수를 고른다.
+    template<class V>
+    static inline __attribute__((always_inline)) void nonLosing(const V &position, const V &mask, V &out)
+    {
+      V possible = (mask + Position::bottom_mask) & Position::board_mask;
+      V opponent = position ^ mask, opponentWin, hasForced, manyForced;
+      winning(opponent, mask, opponentWin);
+      V forced = possible & opponentWin;
+      nonZero(forced, hasForced);
+      nonZero(V(forced & (forced - 1)), manyForced);
+      possible = (forced & hasForced) | (possible & ~hasForced);
+      out = possible & ~(opponentWin >> 1) & ~manyForced;
+    }
+
+#ifdef BULK_EVAL_X86
+    typedef uint64_t V4 __attribute__((vector_size(32)));
+    typedef uint64_t V8 __attribute__((vector_size(64)));
+    // 배열의 임의 위치를 읽고 쓰기 위한 8바이트 정렬 타입. 템플릿 인자로 넘기면 정렬 속성이 사라지므로
+    // 읽은 값은 V4/V8 지역 변수에 담아 계산한다.
+    typedef V4 U4 __attribute__((aligned(8), may_alias));
+    typedef V8 U8 __attribute__((aligned(8), may_alias));
+
+    __attribute__((target("avx2")))
+    static size_t winning256(const uint64_t *position, const uint64_t *mask, uint64_t *out, size_t n)
+    {
+      size_t i = 0;
+      for(; i + 4 <= n; i += 4) {
+        V4 p = *(const U4*)(position + i), m = *(const U4*)(mask + i), r;
+        winning(p, m, r);
+        *(U4*)(out + i) = r;
+      }
+      return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t winning512(const uint64_t *position, const uint64_t *mask, uint64_t *out, size_t n)
+    {
+      size_t i = 0;
+      for(; i + 8 <= n; i += 8) {
+        V8 p = *(const U8*)(position + i), m = *(const U8*)(mask + i), r;
+        winning(p, m, r);
+        *(U8*)(out + i) = r;
+      }
+      return i;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t nonLosing256(const uint64_t *position, const uint64_t *mask, uint64_t *out, size_t n)
+    {
+      size_t i = 0;
+      for(; i + 4 <= n; i += 4) {
+        V4 p = *(const U4*)(position + i), m = *(const U4*)(mask + i), r;
+        nonLosing(p, m, r);
+        *(U4*)(out + i) = r;
+      }
+      return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t nonLosing512(const uint64_t *position, const uint64_t *mask, uint64_t *out, size_t n)
+    {
+      size_t i = 0;
+      for(; i + 8 <= n; i += 8) {
+        V8 p = *(const U8*)(position + i), m = *(const U8*)(mask + i), r;
+        nonLosing(p, m, r);
+        *(U8*)(out + i) = r;
+      }
+      return i;
+    }
+
+    // AVX2 에는 64비트 popcount 가 없으므로 4비트 단위 표 조회(pshufb) 결과를 바이트 합(psadbw)으로 모은다.
+    __attribute__((target("avx2")))
+    static size_t scores256(const uint64_t *position, const uint64_t *mask, const uint64_t *move, int *out, size_t n)
+    {
+      const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+      const __m256i low = _mm256_set1_epi8(0x0f);
+      const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+      size_t i = 0;
+      for(; i + 4 <= n; i += 4) {
+        V4 p = *(const U4*)(position + i) | *(const U4*)(move + i), m = *(const U4*)(mask + i), v;
+        winning(p, m, v);
+        __m256i w = __m256i(v);
+        __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(w, low)),
+                                    _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi64(w, 4), low)));
+        c = _mm256_permutevar8x32_epi32(_mm256_sad_epu8(c, _mm256_setzero_si256()), even);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(c));
+      }
+      return i;
+    }
+
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    static size_t scores512(const uint64_t *position, const uint64_t *mask, const uint64_t *move, int *out, size_t n)
+    {
+      size_t i = 0;
+      for(; i + 8 <= n; i += 8) {
+        V8 p = *(const U8*)(position + i) | *(const U8*)(move + i), m = *(const U8*)(mask + i), v;
+        winning(p, m, v);
+        __m512i w = __m512i(v);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm512_maskz_cvtepi64_epi32(0xff, _mm512_popcnt_epi64(w)));
+      }
+      return i;
+    }
+#endif
+  };
+
+}}
+
+#endif
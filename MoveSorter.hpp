@@ -34,11 +34,98 @@
 #include "position.hpp"
 
 namespace GameSolver { namespace Connect4 {
-  class MoveSorter {
+
+  /*
+   * Killer columns and history counters learned from beta cutoffs.
+   * Killers are kept per ply (number of moves played), history per (player, cell).
+   * One instance belongs to one search thread, so no synchronisation is needed.
+   * @param Position: board type, an instance of BasicPosition.
+   */
+  template<class Position>
+  class BasicMoveHistory {
+  public:
+    typedef typename Position::bitboard_t bitboard_t;
+    // bonus() is always below SCALE, so a threat score multiplied by SCALE dominates it.
+    static const int SCALE = 1 << 16;
+
+    /*
+     * Record that move produced a beta cutoff at ply.
+     * Deeper cutoffs (fewer remaining moves) are worth less.
+     */
+    void cutoff(int ply, bitboard_t move)
+    {
+      int col = Position::moveColumn(move);
+      if(killers[ply][0] != col) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = col;
+      }
+      unsigned int &h = history[ply & 1][cell(move)];
+      h += Position::WIDTH*Position::HEIGHT - ply;
+      if(h > MAX_HISTORY) age();
+    }
+
+    /*
+     * Ordering bonus of move at ply, in [0, SCALE).
+     * The first killer beats the second one, which beats any history count.
+     */
+    int bonus(int ply, bitboard_t move) const
+    {
+      int col = Position::moveColumn(move);
+      int b = history[ply & 1][cell(move)];
+      if(col == killers[ply][0]) b += SCALE/2;
+      else if(col == killers[ply][1]) b += SCALE/4;
+      return b;
+    }
+
+    void clear()
+    {
+      for(int i = 0; i <= Position::WIDTH*Position::HEIGHT; i++) killers[i][0] = killers[i][1] = -1;
+      for(int p = 0; p < 2; p++)
+        for(int i = 0; i < Position::WIDTH*(Position::HEIGHT+1); i++) history[p][i] = 0;
+    }
+
+    BasicMoveHistory()
+    {
+      clear();
+    }
+
+  private:
+    static const unsigned int MAX_HISTORY = SCALE/4 - 1;
+
+    // halve every counter so that recent cutoffs weigh more and counters stay below MAX_HISTORY.
+    void age()
+    {
+      for(int p = 0; p < 2; p++)
+        for(int i = 0; i < Position::WIDTH*(Position::HEIGHT+1); i++) history[p][i] >>= 1;
+    }
+
+    static int cell(bitboard_t move)
+    {
+      return lowestBit(move);
+    }
+
+    int killers[Position::WIDTH*Position::HEIGHT+1][2];
+    unsigned int history[2][Position::WIDTH*(Position::HEIGHT+1)];
+  };
+
+  /*
+   * Sorts the moves of one position, at most Position::WIDTH of them.
+   * @param Position: board type, an instance of BasicPosition.
+   */
+  template<class Position>
+  class BasicMoveSorter {
   public:
+    typedef BasicMoveHistory<Position> MoveHistory;
+    typedef typename Position::bitboard_t bitboard_t;
 
-    void add(uint64_t move, int score)
+    /*
+     * Add a move with its score.
+     * When built with a MoveHistory, the score is blended with the killer/history bonus
+     * of the move. The given score stays the primary key and the bonus breaks ties.
+     */
+    void add(bitboard_t move, int score)
     {
+      if(history) score = score * MoveHistory::SCALE + history->bonus(ply, move);
       int pos = size++;
       for(; pos && entries[pos-1].score > score; --pos) entries[pos] = entries[pos-1];
       entries[pos].move = move;
@@ -50,7 +137,7 @@ namespace GameSolver { namespace Connect4 {
      * @return next remaining move with max score and remove it from the container.
      * If no more move is available return 0
      */
-    uint64_t getNext()
+    bitboard_t getNext()
     {
       if(size)
         return entries[--size].move;
@@ -69,7 +156,14 @@ namespace GameSolver { namespace Connect4 {
     /*
      * Build an empty container
      */
-    MoveSorter(): size{0}
+    BasicMoveSorter(): size{0}, history{0}, ply{0}
+    {
+    }
+
+    /*
+     * Build an empty container ordering moves of ply with the help of history (may be null)
+     */
+    BasicMoveSorter(const MoveHistory *history, int ply): size{0}, history{history}, ply{ply}
     {
     }
 
@@ -77,10 +171,17 @@ namespace GameSolver { namespace Connect4 {
     // number of stored moves
     unsigned int size;
 
+    // optional killer/history heuristics
+    const MoveHistory *history;
+    int ply;
+
     // Contains size moves with their score ordered by score
-    struct {uint64_t move; int score;} entries[Position::WIDTH];
+    struct {bitboard_t move; int score;} entries[Position::WIDTH];
   };
 
+  typedef BasicMoveHistory<Position> MoveHistory;
+  typedef BasicMoveSorter<Position> MoveSorter;
+
 }}; // namespaces
 
 #endif
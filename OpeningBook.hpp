@@ -0,0 +1,152 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef OPENING_BOOK_HPP
+#define OPENING_BOOK_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "position.hpp"
+
+namespace GameSolver { namespace Connect4 {
+
+  // 오프닝 북
+  // C4BookGen 으로 초반 N수까지의 모든 포지션을 미리 풀어둔 파일을 mmap 으로 열어 사용한다.
+  //
+  // 파일 구조 : 헤더(32바이트) + 정렬된 64비트 엔트리 배열
+  //   엔트리 = 포지션 키 << 8 | (점수 - MIN_SCORE + 1)
+  // 키가 상위 비트에 있으므로 엔트리 배열을 그대로 이분 탐색할 수 있다.
+  // 좌우 대칭인 포지션은 점수가 같으므로 둘 중 작은 키 하나만 저장한다.
+  class OpeningBook {
+    public:
+
+    // 북에 없는 포지션을 나타내는 값
+    static const int MISSING = -1000;
+
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t width, height;
+      uint32_t depth;   // 0 ~ depth 수까지의 포지션을 포함한다.
+      uint64_t count;   // 엔트리 개수
+    };
+
+    OpeningBook(): mapping{0}, length{0}, entries{0}, count{0}, maxDepth{-1} {}
+
+    ~OpeningBook()
+    {
+      close();
+    }
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // 북 파일을 연다. 보드 크기가 다르거나 형식이 맞지 않으면 false 를 리턴한다.
+    bool open(const char *path)
+    {
+      close();
+      int fd = ::open(path, O_RDONLY);
+      if(fd < 0) return false;
+      struct stat st;
+      void *p = MAP_FAILED;
+      if(fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header))
+        p = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if(p == MAP_FAILED) return false;
+
+      const Header *h = static_cast<const Header*>(p);
+      if(memcmp(h->magic, MAGIC, 8) != 0 || h->version != VERSION ||
+         h->width != Position::WIDTH || h->height != Position::HEIGHT ||
+         size_t(st.st_size) != sizeof(Header) + h->count * sizeof(uint64_t)) {
+        munmap(p, st.st_size);
+        return false;
+      }
+      mapping = p;
+      length = st.st_size;
+      entries = reinterpret_cast<const uint64_t*>(h + 1);
+      count = h->count;
+      maxDepth = h->depth;
+      return true;
+    }
+
+    void close()
+    {
+      if(mapping) munmap(mapping, length);
+      mapping = 0;
+      entries = 0;
+      count = 0;
+      maxDepth = -1;
+    }
+
+    // nbMoves 수를 둔 포지션이 북에 포함되는지 여부
+    bool covers(int nbMoves) const
+    {
+      return nbMoves <= maxDepth;
+    }
+
+    // 포지션의 점수(현재 착수할 플레이어 입장)를 리턴한다. 없으면 MISSING.
+    int get(const Position &P) const
+    {
+      if(!covers(P.nbMoves())) return MISSING;
+      uint64_t key = P.canonicalKey();
+      const uint64_t *it = std::lower_bound(entries, entries + count, key << 8);
+      if(it == entries + count || (*it >> 8) != key) return MISSING;
+      return int(*it & 0xff) + Position::MIN_SCORE - 1;
+    }
+
+    // 생성기에서 사용 : (Position::canonicalKey(), 점수) 목록을 정렬해 북 파일로 저장한다.
+    static bool write(const char *path, int depth, std::vector<std::pair<uint64_t, int> > positions)
+    {
+      std::vector<uint64_t> data;
+      data.reserve(positions.size());
+      for(auto &p : positions)
+        data.push_back(p.first << 8 | uint64_t(p.second - Position::MIN_SCORE + 1));
+      std::sort(data.begin(), data.end());
+
+      Header h;
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, MAGIC, 8);
+      h.version = VERSION;
+      h.width = Position::WIDTH;
+      h.height = Position::HEIGHT;
+      h.depth = depth;
+      h.count = data.size();
+
+      FILE *f = fopen(path, "wb");
+      if(!f) return false;
+      bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+                fwrite(data.data(), sizeof(uint64_t), data.size(), f) == data.size();
+      return fclose(f) == 0 && ok;
+    }
+
+    private:
+
+    static constexpr const char *MAGIC = "C4BOOK\0\0";
+    static const uint32_t VERSION = 1;
+
+    void *mapping;
+    size_t length;
+    const uint64_t *entries;
+    uint64_t count;
+    int maxDepth;
+  };
+
+}}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef PONDER_HPP
+#define PONDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "position.hpp"
+#include "Solver.hpp"
+
+namespace GameSolver { namespace Connect4 {
+
+  // 상대방 차례에 미리 탐색하기 (pondering)
+  // 솔버가 착수한 직후 start() 를 부르면 백그라운드 스레드가 상대방이 둘 수 있는 모든 수를
+  // 중앙 우선 순서로 하나씩 두어 본 포지션을 풀고, 그 결과를 솔버의 트랜스포지션 테이블에 남긴다.
+  // 상대방이 실제로 착수하면 stop() 으로 탐색을 멈춘다. 이미 푼 수라면 다음 탐색은 대부분 테이블에서 끝난다.
+  //
+  // 탐색은 시간 제한 탐색(solve(P, deadline))을 마감 없이 사용하므로 cancel() 로 언제든 멈출 수 있고,
+  // 중단된 탐색의 결과는 테이블에 남지 않는다. 입력은 호출한 스레드가 그대로 처리한다.
+  // 미리 탐색하는 동안에는 솔버를 다른 곳에서 사용하면 안 되며, stop() 이 리턴한 뒤에 사용한다.
+  class Ponder {
+    public:
+
+    explicit Ponder(Solver &solver): solver(solver), cancelled{false} {}
+
+    ~Ponder()
+    {
+      stop();
+    }
+
+    Ponder(const Ponder&) = delete;
+    Ponder& operator=(const Ponder&) = delete;
+
+    // P (상대방 차례) 에서 상대방의 모든 응수를 미리 탐색하기 시작한다.
+    void start(const Position &P)
+    {
+      stop();
+      for(int col = 0; col < Position::WIDTH; col++) solved[col] = false;
+      cancelled.store(false);
+      thread = std::thread([this, P]() { run(P); });
+    }
+
+    // 미리 탐색을 멈추고 스레드가 끝날 때까지 기다린다.
+    // cancelled 를 먼저 켜므로, 다음 solve() 가 막 시작하면서 stop 을 지우더라도 탐색은 시작하지 않는다.
+    void stop()
+    {
+      if(!thread.joinable()) return;
+      cancelled.store(true);
+      solver.cancel();
+      thread.join();
+    }
+
+    // 상대방이 col 에 두는 경우를 끝까지 풀어 두었는지 여부. stop() 이후에 확인한다.
+    bool isSolved(int col) const
+    {
+      return solved[col];
+    }
+
+    private:
+
+    Solver &solver;
+    std::thread thread;
+    std::atomic<bool> cancelled;
+    bool solved[Position::WIDTH];
+
+    void run(const Position &P)
+    {
+      for(int col : CenterOrder<Position>::columns) {
+        if(cancelled.load()) break;
+        // 둘 수 없는 수와 상대방이 바로 이기는 수(게임 종료)는 풀 필요가 없다.
+        if(!P.canPlay(col) || P.isWinningMove(col)) continue;
+        Position P2(P);
+        P2.playCol(col);
+        Solver::SearchResult r = solver.solve(P2, std::chrono::steady_clock::time_point::max(), &cancelled);
+        solved[col] = r.complete;
+      }
+    }
+  };
+
+}}
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "position.hpp"
+
+namespace GameSolver { namespace Connect4 {
+
+  // 컬럼별 점수(analyze() 결과) 캐시
+  // 같은 포지션(자주 나오는 오프닝, 퍼즐 포지션)의 분석 요청이 반복될 때 탐색 없이 바로 답한다.
+  // 트랜스포지션 테이블은 탐색 중에 덮어써지므로 루트 결과가 남아 있다는 보장이 없지만,
+  // 이 캐시는 확정된 결과만 담고 용량을 넘을 때 가장 오래 쓰지 않은 포지션부터 지운다. (LRU)
+  //
+  // 키는 좌우 대칭을 합친 canonicalKey() 이고, 점수는 키 방향으로 저장해 조회한 쪽의 방향으로 돌려준다.
+  // 여러 스레드가 동시에 사용할 수 있도록 키로 나눈 샤드마다 잠금과 LRU 목록을 따로 둔다.
+  //
+  // 같은 포지션을 이미 누군가 계산 중이면 새 요청은 탐색을 다시 시작하지 않고 그 결과를 기다린다.
+  //   lookup() 이 MISS 를 리턴하면 호출한 쪽이 계산해서 publish() 로 결과를 넘겨야 하고 (실패하면 abandon()),
+  //   JOINED 를 리턴하면 계산이 끝날 때 waiter 가 계산한 스레드에서 불린다.
+  // get() 은 이 과정을 블로킹 호출 하나로 묶은 것이다.
+  template<class Position>
+  class BasicResultCache {
+    public:
+
+    typedef typename Position::bitboard_t bitboard_t;
+
+    // 계산이 끝났을 때 기다리던 쪽에 결과를 넘기는 콜백. ok 가 false 면 계산이 중단된 것이다.
+    typedef std::function<void(bool ok, const std::vector<int> &scores)> Waiter;
+
+    enum Lookup { HIT, MISS, JOINED };
+
+    // 점수가 없는 컬럼(착수할 수 없는 컬럼)의 값. Solver::INVALID_MOVE 와 같다.
+    static const int INVALID = -1000;
+
+    static const int SHARDS = 16;
+
+    // capacity : 저장할 포지션 수 상한. 0 이면 결과를 저장하지 않고 동시 요청 합치기만 한다.
+    explicit BasicResultCache(size_t capacity): hits{0}, misses{0}, coalesced{0}, evictions{0}
+    {
+      for(auto &s : shards) s.capacity = (capacity + SHARDS - 1) / SHARDS;
+    }
+
+    BasicResultCache(const BasicResultCache&) = delete;
+    BasicResultCache& operator=(const BasicResultCache&) = delete;
+
+    /**
+     * P 의 컬럼별 점수를 찾는다.
+     * @return HIT    : scores 에 결과를 담았다.
+     *         MISS   : 호출한 쪽이 계산을 맡는다. 끝나면 publish(), 실패하면 abandon() 을 불러야 한다.
+     *         JOINED : 같은 포지션을 계산 중이다. 그 계산이 끝나면 waiter 가 불린다.
+     */
+    Lookup lookup(const Position &P, std::vector<int> &scores, const Waiter &waiter)
+    {
+      bool mirrored = false;
+      bitboard_t key = P.canonicalKey(mirrored);
+      Shard &s = shard(key);
+      std::lock_guard<std::mutex> lock(s.mutex);
+      if(find(s, key, mirrored, scores)) return HIT;
+      auto it = s.pending.find(key);
+      if(it != s.pending.end()) {
+        it->second.push_back(Pending{waiter, mirrored});
+        coalesced++;
+        return JOINED;
+      }
+      s.pending[key];
+      return MISS;
+    }
+
+    // 계산 중인 요청과 합치지 않고 결과가 있을 때만 가져온다.
+    bool peek(const Position &P, std::vector<int> &scores)
+    {
+      bool mirrored = false;
+      bitboard_t key = P.canonicalKey(mirrored);
+      Shard &s = shard(key);
+      std::lock_guard<std::mutex> lock(s.mutex);
+      return find(s, key, mirrored, scores);
+    }
+
+    // lookup() 이 MISS 였던 P 의 결과를 저장하고, 기다리던 쪽에 넘긴다.
+    void publish(const Position &P, const std::vector<int> &scores)
+    {
+      bool mirrored = false;
+      bitboard_t key = P.canonicalKey(mirrored);
+      Shard &s = shard(key);
+      std::vector<Pending> waiters;
+      {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        take(s, key, waiters);
+        if(s.capacity && !s.index.count(key)) {
+          Entry e;
+          e.key = key;
+          for(int col = 0; col < Position::WIDTH; col++) {
+            int score = scores[mirrored ? Position::WIDTH-1 - col : col];
+            e.scores[col] = score == INVALID ? NONE : (signed char)score;
+          }
+          s.lru.push_front(e);
+          s.index[key] = s.lru.begin();
+          if(s.index.size() > s.capacity) {
+            s.index.erase(s.lru.back().key);
+            s.lru.pop_back();
+            evictions++;
+          }
+        }
+      }
+      std::vector<int> flipped(scores.rbegin(), scores.rend());
+      for(Pending &p : waiters) p.waiter(true, p.mirrored == mirrored ? scores : flipped);
+    }
+
+    // lookup() 이 MISS 였던 P 의 계산을 포기한다. 기다리던 쪽에는 ok = false 로 알린다.
+    void abandon(const Position &P)
+    {
+      bool mirrored = false;
+      bitboard_t key = P.canonicalKey(mirrored);
+      Shard &s = shard(key);
+      std::vector<Pending> waiters;
+      {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        take(s, key, waiters);
+      }
+      std::vector<int> none;
+      for(Pending &p : waiters) p.waiter(false, none);
+    }
+
+    /**
+     * 캐시에 있으면 바로, 누군가 계산 중이면 그 결과를 기다려서, 아니면 compute(P) 로 계산해서 리턴한다.
+     * compute 가 예외를 던지면 기다리던 쪽에는 실패를 알리고 예외를 그대로 전달한다.
+     * 기다리던 계산이 실패하면 직접 계산한다.
+     */
+    std::vector<int> get(const Position &P, const std::function<std::vector<int>(const Position&)> &compute)
+    {
+      for(;;) {
+        std::vector<int> scores;
+        std::shared_ptr<std::promise<std::pair<bool, std::vector<int> > > > result(new std::promise<std::pair<bool, std::vector<int> > >());
+        Lookup l = lookup(P, scores, [result](bool ok, const std::vector<int> &s) { result->set_value(std::make_pair(ok, s)); });
+        if(l == HIT) return scores;
+        if(l == JOINED) {
+          std::pair<bool, std::vector<int> > r = result->get_future().get();
+          if(r.first) return r.second;
+          continue;
+        }
+        try {
+          scores = compute(P);
+        } catch(...) {
+          abandon(P);
+          throw;
+        }
+        publish(P, scores);
+        return scores;
+      }
+    }
+
+    // 저장된 포지션 수
+    size_t size()
+    {
+      size_t n = 0;
+      for(auto &s : shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        n += s.index.size();
+      }
+      return n;
+    }
+
+    unsigned long long hitCount() const { return hits; }
+    unsigned long long missCount() const { return misses; }
+    // 계산 중인 같은 포지션의 결과를 기다린 요청 수 (missCount() 에 포함된다)
+    unsigned long long coalescedCount() const { return coalesced; }
+    unsigned long long evictionCount() const { return evictions; }
+
+    private:
+
+    // 저장된 점수 중 INVALID 를 나타내는 값
+    static const signed char NONE = -128;
+
+    struct Entry {
+      bitboard_t key;
+      signed char scores[Position::WIDTH];
+    };
+
+    struct Pending {
+      Waiter waiter;
+      bool mirrored;
+    };
+
+    struct Hash {
+      size_t operator()(bitboard_t key) const
+      {
+        // 128비트 키는 두 64비트 절반을 합친다. (64비트 키에서 >> 64 를 피하려고 두 번 쉬프트한다)
+        uint64_t h = uint64_t(key) ^ uint64_t(key >> 32 >> 32);
+        return size_t(h * 0x9E3779B97F4A7C15ULL >> 16);
+      }
+    };
+
+    struct Shard {
+      std::mutex mutex;
+      std::list<Entry> lru;   // 앞쪽일수록 최근에 사용
+      std::unordered_map<bitboard_t, typename std::list<Entry>::iterator, Hash> index;
+      std::unordered_map<bitboard_t, std::vector<Pending>, Hash> pending;   // 계산 중인 포지션과 기다리는 요청
+      size_t capacity;
+    };
+
+    Shard shards[SHARDS];
+    std::atomic<unsigned long long> hits, misses, coalesced, evictions;
+
+    Shard& shard(bitboard_t key)
+    {
+      return shards[(Hash()(key) >> 40) % SHARDS];
+    }
+
+    // 잠금을 잡은 상태에서 부른다. 찾으면 LRU 목록의 맨 앞으로 옮긴다.
+    bool find(Shard &s, bitboard_t key, bool mirrored, std::vector<int> &scores)
+    {
+      auto it = s.index.find(key);
+      if(it == s.index.end()) {
+        misses++;
+        return false;
+      }
+      s.lru.splice(s.lru.begin(), s.lru, it->second);
+      scores.resize(Position::WIDTH);
+      for(int col = 0; col < Position::WIDTH; col++) {
+        signed char score = it->second->scores[mirrored ? Position::WIDTH-1 - col : col];
+        scores[col] = score == NONE ? INVALID : score;
+      }
+      hits++;
+      return true;
+    }
+
+    // 잠금을 잡은 상태에서 부른다. key 를 기다리던 요청을 꺼낸다.
+    static void take(Shard &s, bitboard_t key, std::vector<Pending> &waiters)
+    {
+      auto it = s.pending.find(key);
+      if(it == s.pending.end()) return;
+      waiters.swap(it->second);
+      s.pending.erase(it);
+    }
+  };
+
+  typedef BasicResultCache<Position> ResultCache;
+
+}}
+
+#endif
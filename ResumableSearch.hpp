@@ -0,0 +1,626 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef RESUMABLE_SEARCH_HPP
+#define RESUMABLE_SEARCH_HPP
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include "position.hpp"
+#include "Solver.hpp"
+
+namespace GameSolver { namespace Connect4 {
+
+  // 중단했다가 이어서 진행할 수 있는 탐색
+  // negamax() 와 같은 탐색을 재귀 호출 대신 포지션 하나당 프레임 하나인 명시적 스택으로 진행한다.
+  // run(budget) 은 노드를 budget 개 정도 탐색하고 리턴하며, 다음 run() 은 멈춘 곳에서 이어서 탐색한다.
+  // 따라서 스레드 하나가 여러 탐색을 번갈아 진행할 수 있다. (SearchScheduler)
+  //
+  //   SCORE   : solve(P) 와 같은 점수 (이분 탐색)
+  //   BEST    : solve(P, deadline) 과 같은 점수 범위와 최선의 수 (루트 널 윈도우 탐색)
+  //   ANALYZE : 컬럼별 점수. analyze() 와 같은 결과를 컬럼 순서대로 하나씩 계산한다.
+  //
+  // 노드 방문 순서, 테이블 사용과 통계는 재귀 탐색과 같으므로 결과와 노드 수도 같다.
+  // 솔버의 테이블과 설정(대칭, 킬러/히스토리)을 사용하고, 통계와 킬러/히스토리는 탐색마다 따로 모은다.
+  // 같은 솔버의 탐색 여러 개를 같은 스레드에서 번갈아 진행할 수 있지만, 솔버의 다른 탐색과 동시에 진행하면 안 된다.
+  template<int W, int H>
+  class BasicSolver<W, H>::Resumable {
+    public:
+
+    enum Kind { SCORE, BEST, ANALYZE };
+
+    Resumable(BasicSolver &solver, const Position &P, Kind kind):
+      solver(solver), P(P), kind(kind), w(&solver.transTable, ColumnOrder::columns, false),
+      frames(Position::WIDTH*Position::HEIGHT), depth{0}, immediate{0}, calling{false}, finished{false}, stopped{false},
+      low{-(Position::WIDTH*Position::HEIGHT - P.nbMoves())/2}, high{(Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2},
+      med{0}, col{0}, probeIndex{0}, probeBest{-1}, proven{false}, finalProbe{false}
+    {
+      r.lower = low;
+      r.upper = high;
+      r.bestMove = -1;
+      r.complete = false;
+      if(kind == ANALYZE) values.assign(Position::WIDTH, INVALID_MOVE);
+    }
+
+    Resumable(const Resumable&) = delete;
+    Resumable& operator=(const Resumable&) = delete;
+
+    /**
+     * 노드를 budget 개 정도 더 탐색한다. 진행 중인 노드 하나는 끝까지 처리하므로 조금 넘을 수 있다.
+     * @return 탐색이 끝났으면 true
+     */
+    bool run(unsigned long long budget)
+    {
+      unsigned long long limit = w.stats.nodes + budget;
+      while(!finished) {
+        int value = 0;
+        bool had = calling;
+        if(calling) {
+          if(!resume(limit, value)) return false;
+          calling = false;
+        }
+        advance(had, value);
+      }
+      return true;
+    }
+
+    // 탐색을 멈추고 끝난 것으로 한다. 결과는 그때까지 증명된 범위이다. (BEST, SCORE)
+    // 진행 중이던 노드들의 결과는 테이블에 남지 않는다.
+    void stop()
+    {
+      if(finished) return;
+      if(kind == SCORE) {
+        r.lower = low;
+        r.upper = high;
+      }
+      r.complete = r.lower == r.upper;
+      finished = stopped = true;
+      calling = false;
+      depth = 0;
+    }
+
+    bool done() const
+    {
+      return finished;
+    }
+
+    // stop() 으로 중단되었는지 여부
+    bool wasStopped() const
+    {
+      return stopped;
+    }
+
+    Kind getKind() const
+    {
+      return kind;
+    }
+
+    const Position& position() const
+    {
+      return P;
+    }
+
+    // SCORE, BEST 의 결과. SCORE 는 bestMove 가 -1 이다.
+    const SearchResult& result() const
+    {
+      return r;
+    }
+
+    // ANALYZE 의 결과. 착수할 수 없는(또는 중단되어 계산하지 못한) 컬럼은 INVALID_MOVE.
+    const std::vector<int>& scores() const
+    {
+      return values;
+    }
+
+    // 지금까지 탐색한 노드 수
+    unsigned long long nodes() const
+    {
+      return w.stats.nodes;
+    }
+
+    const SearchStats& stats() const
+    {
+      return w.stats;
+    }
+
+    private:
+
+    // negamax() 호출 하나의 지역 변수. move 는 탐색 중인 자식 수이다.
+    struct Frame {
+      Position P;
+      int alpha, beta;
+      int max, lower;
+      int bestMove, moveIndex;
+      bool mirrored;
+      bitboard_t key;
+      bitboard_t move;
+      MoveSorter moves;
+    };
+
+    BasicSolver &solver;
+    const Position P;
+    const Kind kind;
+    Worker w;
+
+    // 명시적 스택. 프레임은 n 수를 둔 포지션에서 W*H-2 수 전까지만 만들어지므로 크기를 미리 정해 둔다.
+    std::vector<Frame> frames;
+    int depth;          // 사용 중인 프레임 수
+    int immediate;      // 프레임 없이 바로 끝난 호출의 값
+    bool calling;       // negamax 호출이 진행 중
+    bool finished;
+    bool stopped;
+
+    SearchResult r;
+    std::vector<int> values;
+
+    // 이분 탐색 (SCORE, ANALYZE) : Q 의 점수가 [low, high] 안에 있다.
+    Position Q;
+    int low, high;
+    int med;            // 진행 중인 널 윈도우 (BEST 도 사용)
+    int col;            // ANALYZE 에서 계산 중인 컬럼
+
+    // 루트 널 윈도우 탐색 (BEST)
+    std::vector<int> cols;
+    size_t probeIndex;
+    int probeBest;
+    bool proven;        // r.bestMove 가 r.lower 이상임이 증명되었는지 여부
+    bool finalProbe;    // 점수가 확정된 뒤 그 점수를 내는 수를 찾는 중
+
+    // negamax() 의 앞부분. 자식을 탐색하기 전에 값이 정해지면 true 와 value 를 리턴하고,
+    // 아니면 프레임을 만들고 false 를 리턴한다.
+    bool enter(const Position &P, int alpha, int beta, int &value)
+    {
+      assert(alpha < beta);
+      assert(!P.canWinNext());
+
+      w.stats.nodes++;
+      SOLVER_STAT(w.stats.depthNodes[P.nbMoves()]++);
+
+      bitboard_t next = P.possibleNonLosingMoves();
+      if(next == 0) {
+        value = -(Position::WIDTH*Position::HEIGHT - P.nbMoves())/2;
+        return true;
+      }
+      if(P.nbMoves() >= Position::WIDTH*Position::HEIGHT - 2) {
+        value = 0;
+        return true;
+      }
+
+      int min = -(Position::WIDTH*Position::HEIGHT-2 - P.nbMoves())/2;
+      if(alpha < min) {
+        alpha = min;
+        if(alpha >= beta) {
+          value = alpha;
+          return true;
+        }
+      }
+
+      int max = (Position::WIDTH*Position::HEIGHT-1 - P.nbMoves())/2;
+
+      bool mirrored = false;
+      bitboard_t key = solver.symmetry ? P.canonicalKey(mirrored) : P.key();
+      int tableMove = -1;
+      int lower = NO_BOUND;
+      SOLVER_STAT(w.stats.ttProbes++);
+      if(unsigned int val = w.table->get(key)) {
+        SOLVER_STAT(w.stats.ttHits++; if(solver.trackReuse && w.table->isPrevious(key)) w.stats.ttPreviousHits++);
+        max = valueUpper(val);
+        lower = valueLower(val);
+        tableMove = valueMove(val, mirrored);
+        if(alpha < lower) {
+          alpha = lower;
+          if(alpha >= beta) {
+            value = alpha;
+            return true;
+          }
+        }
+      }
+
+      if(beta > max) {
+        beta = max;
+        if(alpha >= beta) {
+          value = beta;
+          return true;
+        }
+      }
+
+      Frame &f = frames[depth++];
+      f.P = P;
+      f.alpha = alpha;
+      f.beta = beta;
+      f.max = max;
+      f.lower = lower;
+      f.bestMove = tableMove;
+      f.moveIndex = 0;
+      f.mirrored = mirrored;
+      f.key = key;
+      f.moves = MoveSorter(solver.moveHistory ? &w.history : 0, P.nbMoves());
+      for(int i = Position::WIDTH; i--;) {
+        if(bitboard_t move = next & Position::column_mask(w.order[i])) {
+          f.moves.add(move, w.order[i] == tableMove ? TABLE_MOVE_SCORE : P.moveScore(move));
+          if(solver.prefetch) solver.prefetchChild(P, move, w);
+        }
+      }
+      return false;
+    }
+
+    // 자식 f.move 의 점수를 f 에 반영한다. 베타 컷이면 테이블에 기록하고 true 와 f 의 값을 리턴한다.
+    bool childScore(Frame &f, int score, int &value)
+    {
+      if(score >= f.beta) {
+        SOLVER_STAT(w.stats.cutoffs++; if(f.moveIndex == 0) w.stats.firstMoveCutoffs++);
+        if(solver.moveHistory) w.history.cutoff(f.P.nbMoves(), f.move);
+        if(w.table->put(f.key, packValue(f.max, score > f.lower ? score : f.lower, Position::moveColumn(f.move), f.mirrored), f.P.nbMoves()))
+          SOLVER_STAT(w.stats.ttOverwrites++);
+        SOLVER_STAT(w.stats.ttStores++);
+        value = score;
+        return true;
+      }
+      if(score > f.alpha) {
+        f.alpha = score;
+        f.bestMove = Position::moveColumn(f.move);
+      }
+      f.moveIndex++;
+      return false;
+    }
+
+    // negamax(P, alpha, beta) 호출을 시작한다. 진행은 resume() 이 한다.
+    void begin(const Position &P, int alpha, int beta)
+    {
+      depth = 0;
+      enter(P, alpha, beta, immediate);
+      calling = true;
+    }
+
+    // 진행 중인 호출을 노드 수가 limit 이 될 때까지 진행한다. 호출이 끝나면 true 와 그 값을 리턴한다.
+    bool resume(unsigned long long limit, int &value)
+    {
+      if(depth == 0) {
+        value = immediate;
+        return true;
+      }
+      while(w.stats.nodes < limit) {
+        Frame &f = frames[depth-1];
+        int v;
+        if(bitboard_t next = f.moves.getNext()) {
+          f.move = next;
+          Position P2(f.P);
+          P2.play(next);
+          if(!enter(P2, -f.beta, -f.alpha, v) || !childScore(f, -v, v)) continue;
+        } else {
+          if(w.table->put(f.key, packValue(f.alpha, f.lower, f.bestMove, f.mirrored), f.P.nbMoves()))
+            SOLVER_STAT(w.stats.ttOverwrites++);
+          SOLVER_STAT(w.stats.ttStores++);
+          v = f.alpha;
+        }
+        // f 가 값 v 로 끝났다. 부모 프레임에 차례로 전달한다.
+        while(--depth > 0 && childScore(frames[depth-1], -v, v)) {}
+        if(depth == 0) {
+          value = v;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // 진행 중인 호출이 없을 때 작업의 다음 호출을 시작하거나 작업을 끝낸다.
+    // had 가 true 면 value 는 직전 호출의 값이다.
+    void advance(bool had, int value)
+    {
+      if(kind == SCORE) advanceScore(had, value);
+      else if(kind == BEST) advanceBest(had, value);
+      else advanceAnalyze(had, value);
+    }
+
+    // search() 의 널 윈도우를 하나 시작한다. 점수가 이미 정해졌으면 false 와 score 를 리턴한다.
+    bool nextWindow(int &score)
+    {
+      if(low >= high) {
+        score = low;
+        return false;
+      }
+      med = low + (high - low)/2;
+      if(med <= 0 && low/2 < med) med = low/2;
+      else if(med >= 0 && high/2 > med) med = high/2;
+      SOLVER_STAT(w.stats.nullWindowSearches++);
+      begin(Q, med, med + 1);
+      return true;
+    }
+
+    // solveWith() 처럼 Q 의 점수를 구하기 시작한다. 바로 정해지면 false 와 score 를 리턴한다.
+    bool startBisect(const Position &Q, int &score)
+    {
+      if(Q.canWinNext()) {
+        score = (Position::WIDTH*Position::HEIGHT+1 - Q.nbMoves())/2;
+        return false;
+      }
+      this->Q = Q;
+      low = -(Position::WIDTH*Position::HEIGHT - Q.nbMoves())/2;
+      high = (Position::WIDTH*Position::HEIGHT+1 - Q.nbMoves())/2;
+      return nextWindow(score);
+    }
+
+    // 직전 널 윈도우의 값을 반영하고 다음 널 윈도우를 시작한다.
+    bool bisect(int value, int &score)
+    {
+      if(value <= med) high = value;
+      else low = value;
+      return nextWindow(score);
+    }
+
+    void advanceScore(bool had, int value)
+    {
+      int score;
+      if(had ? bisect(value, score) : startBisect(P, score)) return;
+      r.lower = r.upper = score;
+      r.complete = true;
+      finished = true;
+    }
+
+    void advanceAnalyze(bool had, int value)
+    {
+      int score;
+      if(had) {
+        if(bisect(value, score)) return;
+        values[col++] = -score;
+      }
+      for(; col < Position::WIDTH; col++) {
+        if(!P.canPlay(col)) continue;
+        if(P.isWinningMove(col)) {
+          values[col] = (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+          continue;
+        }
+        Position P2(P);
+        P2.playCol(col);
+        if(startBisect(P2, score)) return;
+        values[col] = -score;
+      }
+      finished = true;
+    }
+
+    // solve(P, deadline) 의 탐색 전 처리. 탐색 없이 결과가 정해지면 false 를 리턴한다.
+    bool startBest()
+    {
+      const int n = P.nbMoves();
+      for(int c : ColumnOrder::columns) {
+        if(P.canPlay(c) && P.isWinningMove(c)) {
+          r.lower = r.upper = (Position::WIDTH*Position::HEIGHT+1 - n)/2;
+          r.bestMove = c;
+          r.complete = true;
+          return false;
+        }
+      }
+
+      bitboard_t next = P.possibleNonLosingMoves();
+      MoveSorter moves;
+      for(int i = Position::WIDTH; i--;)
+        if(bitboard_t move = next & Position::column_mask(ColumnOrder::columns[i]))
+          moves.add(move, P.moveScore(move));
+      while(bitboard_t move = moves.getNext())
+        cols.push_back(Position::moveColumn(move));
+
+      if(cols.empty()) {
+        for(int c : ColumnOrder::columns)
+          if(P.canPlay(c)) {
+            r.bestMove = c;
+            break;
+          }
+        r.lower = r.upper = -(Position::WIDTH*Position::HEIGHT - n)/2;
+        r.complete = true;
+        return false;
+      }
+      r.bestMove = cols[0];
+      if(n >= Position::WIDTH*Position::HEIGHT - 2) {
+        r.lower = r.upper = 0;
+        r.complete = true;
+        return false;
+      }
+      r.lower = -(Position::WIDTH*Position::HEIGHT-2 - n)/2;
+      r.upper = (Position::WIDTH*Position::HEIGHT-1 - n)/2;
+      return true;
+    }
+
+    // rootProbe() 의 다음 자식을 시작한다. 모든 자식이 med 이하였다면 false 를 리턴한다.
+    bool nextProbe()
+    {
+      if(probeIndex == cols.size()) return false;
+      Position P2(P);
+      P2.playCol(cols[probeIndex]);
+      begin(P2, -(med + 1), -med);
+      return true;
+    }
+
+    void startProbe(int m)
+    {
+      med = m;
+      probeIndex = 0;
+      probeBest = -1;
+      nextProbe();
+    }
+
+    void advanceBest(bool had, int value)
+    {
+      if(!had) {
+        if(!startBest()) {
+          finished = true;
+          return;
+        }
+      } else {
+        // rootProbe() 의 자식 하나가 끝났다.
+        int v = -value;
+        if(v > med) probeBest = cols[probeIndex];
+        else {
+          probeIndex++;
+          if(nextProbe()) return;
+          v = med;
+        }
+
+        if(finalProbe) {
+          if(probeBest >= 0) r.bestMove = probeBest;
+          r.complete = true;
+          finished = true;
+          return;
+        }
+        if(v <= med) r.upper = v;
+        else {
+          r.lower = v;
+          r.bestMove = probeBest;
+          proven = true;
+        }
+      }
+
+      if(r.lower < r.upper) {
+        int m;
+        if(r.lower <= 0 && 0 < r.upper) m = 0;
+        else if(r.lower <= -1 && -1 < r.upper) m = -1;
+        else {
+          m = r.lower + (r.upper - r.lower)/2;
+          if(m <= 0 && r.lower/2 < m) m = r.lower/2;
+          else if(m >= 0 && r.upper/2 > m) m = r.upper/2;
+        }
+        SOLVER_STAT(w.stats.nullWindowSearches++);
+        startProbe(m);
+        return;
+      }
+      // 점수는 확정되었지만 그 점수를 내는 수를 아직 찾지 못한 경우
+      if(!proven) {
+        finalProbe = true;
+        startProbe(r.lower - 1);
+        return;
+      }
+      r.complete = true;
+      finished = true;
+    }
+  };
+
+  // 여러 탐색을 스레드 하나에서 노드 수 단위로 번갈아 진행하는 스케줄러
+  // step() 은 지금까지 가장 적게 탐색한 작업을 SLICE 노드만큼 진행한다.
+  // 새 작업은 탐색한 노드가 0 이므로 바로 진행되고, 쉬운 작업은 어려운 작업 뒤에서 기다리지 않고
+  // 몇 조각 안에 끝난다. 어려운 작업은 다른 작업이 모두 그만큼 탐색한 뒤에 진행된다.
+  // 마감 시각을 준 작업은 시각이 지나면 stop() 으로 멈추고 그때까지의 결과로 끝낸다.
+  template<class Solver>
+  class BasicSearchScheduler {
+    public:
+
+    typedef typename Solver::Position Position;
+    typedef typename Solver::Resumable Search;
+    typedef std::function<void(Search&)> Callback;
+    typedef std::chrono::steady_clock Clock;
+
+    // 한 번에 진행하는 노드 수. 시간 제한 탐색이 마감 시각을 확인하는 간격과 같다.
+    static const unsigned long long SLICE = 4096;
+
+    explicit BasicSearchScheduler(Solver &solver): solver(solver), arrivals{0}, timed{0} {}
+
+    // 새 작업을 추가한다. 작업이 끝나면 done 이 불린다.
+    void add(const Position &P, typename Search::Kind kind, Callback done,
+             Clock::time_point deadline = Clock::time_point::max())
+    {
+      Task t;
+      t.search.reset(new Search(solver, P, kind));
+      t.done = done;
+      t.deadline = deadline;
+      t.arrival = arrivals++;
+      t.nodes = 0;
+      if(deadline != Clock::time_point::max()) timed++;
+      tasks.push_back(std::move(t));
+      std::push_heap(tasks.begin(), tasks.end(), later);
+    }
+
+    bool empty() const
+    {
+      return tasks.empty();
+    }
+
+    size_t size() const
+    {
+      return tasks.size();
+    }
+
+    // 가장 적게 탐색한 작업을 진행한다. 작업이 끝나면 콜백을 부르고 빼낸다.
+    // 마감 시각이 지난 작업은 차례를 기다리지 않고 먼저 끝낸다.
+    void step()
+    {
+      if(timed) expire();
+      if(tasks.empty()) return;
+      std::pop_heap(tasks.begin(), tasks.end(), later);
+      Task &t = tasks.back();
+      if(t.search->run(SLICE)) {
+        finish(tasks.size() - 1);
+        return;
+      }
+      t.nodes = t.search->nodes();
+      std::push_heap(tasks.begin(), tasks.end(), later);
+    }
+
+    // 모든 작업이 끝날 때까지 진행한다.
+    void runAll()
+    {
+      while(!tasks.empty()) step();
+    }
+
+    private:
+
+    struct Task {
+      std::unique_ptr<Search> search;
+      Callback done;
+      Clock::time_point deadline;
+      unsigned long long arrival;
+      unsigned long long nodes;   // 힙 비교용. search->nodes() 와 같다.
+    };
+
+    // 힙의 맨 앞이 노드 수가 가장 적은(같으면 먼저 들어온) 작업이 되도록 하는 비교
+    static bool later(const Task &a, const Task &b)
+    {
+      return a.nodes != b.nodes ? a.nodes > b.nodes : a.arrival > b.arrival;
+    }
+
+    // tasks[i] 를 빼내고 콜백을 부른다. 힙 순서는 호출한 쪽에서 맞춘다.
+    void finish(size_t i)
+    {
+      Task t = std::move(tasks[i]);
+      if(i + 1 != tasks.size()) tasks[i] = std::move(tasks.back());
+      tasks.pop_back();
+      if(t.deadline != Clock::time_point::max()) timed--;
+      t.done(*t.search);
+    }
+
+    void expire()
+    {
+      Clock::time_point now = Clock::now();
+      bool removed = false;
+      for(size_t i = 0; i < tasks.size();) {
+        if(now < tasks[i].deadline) {
+          i++;
+          continue;
+        }
+        tasks[i].search->stop();
+        finish(i);
+        removed = true;
+      }
+      if(removed) std::make_heap(tasks.begin(), tasks.end(), later);
+    }
+
+    Solver &solver;
+    std::vector<Task> tasks;
+    unsigned long long arrivals;
+    size_t timed;   // 마감 시각이 있는 작업 수
+  };
+
+  typedef BasicSearchScheduler<Solver> SearchScheduler;
+
+}}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef SEARCH_STATS_HPP
+#define SEARCH_STATS_HPP
+
+#include <ostream>
+#include <cstring>
+
+// 탐색 통계 수집 여부. make CPPFLAGS=-DSOLVER_STATS=0 으로 빌드하면 노드 수를 제외한 통계 코드가 모두 빠진다.
+// 노드 수는 시간 제한 탐색의 마감 확인에 쓰이므로 항상 센다.
+#ifndef SOLVER_STATS
+#define SOLVER_STATS 1
+#endif
+
+#if SOLVER_STATS
+#define SOLVER_STAT(x) do { x; } while(0)
+#else
+#define SOLVER_STAT(x) do {} while(0)
+#endif
+
+namespace GameSolver { namespace Connect4 {
+
+  // solve() 한 번의 탐색 통계. 탐색 스레드마다 하나씩 가지므로 원자적 연산이 필요 없다.
+  struct SearchStats {
+    // 비트보드가 최대 128비트이므로 보드는 128칸을 넘지 않는다. 모든 보드 크기가 같은 통계 구조체를 사용한다.
+    static const int MAX_MOVES = 128;
+
+    unsigned long long nodes;                     // negamax 호출 횟수
+    unsigned long long depthNodes[MAX_MOVES+1];   // 둔 수(nbMoves)별 노드 수
+    unsigned long long ttProbes;                  // 테이블 조회 횟수
+    unsigned long long ttHits;                    // 테이블 조회 성공 횟수
+    unsigned long long ttPreviousHits;            // 이전 수(이전 세대)의 탐색이 남긴 엔트리에서의 조회 성공 횟수
+    unsigned long long ttStores;                  // 테이블 저장 횟수
+    unsigned long long ttOverwrites;              // 다른 포지션의 엔트리를 밀어낸 저장 횟수
+    unsigned long long cutoffs;                   // 베타 컷 횟수
+    unsigned long long firstMoveCutoffs;          // MoveSorter 의 첫 번째 수에서 일어난 베타 컷 횟수
+    unsigned long long nullWindowSearches;        // 루트의 널 윈도우 탐색(이분 탐색 재탐색) 횟수
+
+    void clear()
+    {
+      memset(this, 0, sizeof(*this));
+    }
+
+    SearchStats& operator+=(const SearchStats &o)
+    {
+      nodes += o.nodes;
+      for(int i = 0; i <= MAX_MOVES; i++) depthNodes[i] += o.depthNodes[i];
+      ttProbes += o.ttProbes;
+      ttHits += o.ttHits;
+      ttPreviousHits += o.ttPreviousHits;
+      ttStores += o.ttStores;
+      ttOverwrites += o.ttOverwrites;
+      cutoffs += o.cutoffs;
+      firstMoveCutoffs += o.firstMoveCutoffs;
+      nullWindowSearches += o.nullWindowSearches;
+      return *this;
+    }
+
+    double hitRate() const
+    {
+      return ttProbes ? double(ttHits) / ttProbes : 0;
+    }
+
+    // 테이블 조회 성공 중 이전 수의 탐색 결과를 재사용한 비율
+    double previousHitRate() const
+    {
+      return ttHits ? double(ttPreviousHits) / ttHits : 0;
+    }
+
+    // 베타 컷 중 첫 번째 수에서 일어난 비율. 수 정렬이 좋을수록 1 에 가깝다.
+    double firstMoveCutoffRate() const
+    {
+      return cutoffs ? double(firstMoveCutoffs) / cutoffs : 0;
+    }
+
+    // 한 줄짜리 JSON 객체로 출력한다. depthNodes 는 0 이 아닌 마지막 칸까지만 출력한다.
+    void writeJson(std::ostream &out) const
+    {
+      int last = MAX_MOVES;
+      while(last >= 0 && depthNodes[last] == 0) last--;
+      out << "{\"nodes\":" << nodes << ",\"depthNodes\":[";
+      for(int i = 0; i <= last; i++) out << (i ? "," : "") << depthNodes[i];
+      out << "],\"ttProbes\":" << ttProbes << ",\"ttHits\":" << ttHits
+          << ",\"ttPreviousHits\":" << ttPreviousHits
+          << ",\"ttStores\":" << ttStores << ",\"ttOverwrites\":" << ttOverwrites
+          << ",\"cutoffs\":" << cutoffs << ",\"firstMoveCutoffs\":" << firstMoveCutoffs
+          << ",\"firstMoveCutoffRate\":" << firstMoveCutoffRate() << ",\"hitRate\":" << hitRate()
+          << ",\"nullWindowSearches\":" << nullWindowSearches << '}';
+    }
+  };
+
+}}
+
+#endif
@@ -0,0 +1,596 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "position.hpp"
+#include "Solver.hpp"
+#include "ResumableSearch.hpp"
+#include "ResultCache.hpp"
+
+namespace GameSolver { namespace Connect4 {
+
+  // 서버 모드
+  // 로컬 소켓(유닉스 소켓 또는 127.0.0.1 TCP)으로 여러 클라이언트의 여러 게임(세션)을 동시에 처리한다.
+  // 한 줄에 요청 하나를 보내면 한 줄의 응답("ok ..." 또는 "error 이유")이 요청 순서대로 돌아온다.
+  //
+  //   new [수순]              새 세션을 만든다. 수순(예 "4453")이 있으면 그 포지션에서 시작한다.  -> ok 세션번호
+  //   play 세션 수순           수순대로 착수한다. 마지막 수로 이기면 게임이 끝난다.               -> ok 둔수 [win|draw]
+  //   best 세션 [밀리초]       최선의 수. 시간(0 이면 제한 없음)을 주면 시간 제한 탐색을 한다.   -> ok 컬럼 하한 상한
+  //   analyze 세션            컬럼별 점수 (착수할 수 없는 컬럼은 -)                              -> ok 점수 x 7
+  //   close 세션              세션을 닫는다.                                                     -> ok
+  //   stats                   응답한 요청 수와 결과 캐시 통계            -> ok 요청수 적중 실패 합침 축출 저장수
+  //   quit                    연결을 닫는다.                                                     -> ok
+  //
+  // 세션은 만든 연결에 속한다. 다른 연결에서 그 세션 번호를 쓰면 없는 세션으로 다루고,
+  // 연결이 닫히면(close 없이 끊겨도) 그 연결의 세션도 모두 닫는다.
+  //
+  // 구조
+  //   I/O 스레드 하나가 poll() 로 모든 연결을 처리하고, 세션(포지션)도 이 스레드만 다룬다.
+  //   탐색이 필요한 요청(best, analyze)은 작업 큐에 넣고, 고정된 개수의 워커 스레드가 처리한다.
+  //   워커는 각자 Solver 하나(테이블 64MB)를 가지고 모든 세션의 요청에 재사용하므로,
+  //   세션이 몇 개이든 솔버 메모리는 워커 수 x 64MB 로 고정된다. 세션 하나는 포지션 하나 크기다.
+  //   워커는 받은 요청을 SearchScheduler 에 넣고 4096 노드씩 번갈아 진행하며, 가장 적게 탐색한 요청을 먼저 진행한다.
+  //   따라서 쉬운 요청(게임 후반, 테이블에 남은 포지션)은 먼저 들어온 어려운 요청이 끝나기를 기다리지 않는다.
+  //   연결마다 처리 중인 요청은 하나뿐이므로 응답 순서가 요청 순서와 같다.
+  //
+  // 결과 캐시
+  //   analyze 의 결과는 모든 워커가 공유하는 ResultCache 에 저장하고, 같은 포지션(좌우 대칭 포함)을 다시 물으면
+  //   I/O 스레드에서 워커를 거치지 않고 바로 답한다. 같은 포지션을 계산 중이면 새 요청은 그 결과를 기다린다.
+  //   best 도 캐시에 있는 포지션이면 그 점수로 바로 답한다. (점수가 가장 높은 컬럼 중 중앙에 가까운 것)
+  class Server {
+    public:
+
+    // 동시에 열 수 있는 세션 수 상한
+    static const size_t MAX_SESSIONS = 1 << 20;
+    // 요청 한 줄의 최대 길이. 넘으면 연결을 닫는다.
+    static const size_t MAX_LINE = 1024;
+
+    // 결과 캐시에 저장하는 포지션 수 기본값 (약 8MB)
+    static const size_t DEFAULT_CACHE_SIZE = 1 << 16;
+
+    // cacheSize : 결과 캐시에 저장할 포지션 수. 0 이면 저장하지 않는다.
+    explicit Server(unsigned int workers, size_t cacheSize = DEFAULT_CACHE_SIZE): listenFd{-1}, stopping{false},
+      nextConnection{1}, nextSession{1}, nbWorkers{workers ? workers : 1}, served{0},
+      tableLogSize{Solver::TABLE_LOG_SIZE}, tableFlags{0}, cache(cacheSize)
+    {
+      wake[0] = wake[1] = -1;
+    }
+
+    ~Server()
+    {
+      if(listenFd >= 0) close(listenFd);
+      if(wake[0] >= 0) close(wake[0]);
+      if(wake[1] >= 0) close(wake[1]);
+      if(!unixPath.empty()) unlink(unixPath.c_str());
+    }
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * 소켓을 연다. address 가 숫자뿐이면 127.0.0.1 의 해당 TCP 포트, 아니면 유닉스 소켓 경로이다.
+     * @return 실패하면 false 와 함께 error 에 이유를 남긴다.
+     */
+    bool listen(const std::string &address, std::string &error)
+    {
+      if(pipe(wake) != 0) {
+        error = strerror(errno);
+        return false;
+      }
+      setNonBlocking(wake[0]);
+      setNonBlocking(wake[1]);
+
+      bool tcp = !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+      if(tcp) {
+        sockaddr_in a;
+        memset(&a, 0, sizeof(a));
+        a.sin_family = AF_INET;
+        a.sin_port = htons(atoi(address.c_str()));
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if(listenFd >= 0) setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if(listenFd < 0 || bind(listenFd, (sockaddr*)&a, sizeof(a)) != 0) {
+          error = strerror(errno);
+          return false;
+        }
+      } else {
+        sockaddr_un a;
+        memset(&a, 0, sizeof(a));
+        a.sun_family = AF_UNIX;
+        if(address.size() >= sizeof(a.sun_path)) {
+          error = "socket path is too long";
+          return false;
+        }
+        strcpy(a.sun_path, address.c_str());
+        unlink(address.c_str());
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(listenFd < 0 || bind(listenFd, (sockaddr*)&a, sizeof(a)) != 0) {
+          error = strerror(errno);
+          return false;
+        }
+        unixPath = address;
+      }
+      if(::listen(listenFd, SOMAXCONN) != 0) {
+        error = strerror(errno);
+        return false;
+      }
+      setNonBlocking(listenFd);
+      return true;
+    }
+
+    // stop() 이 불릴 때까지 요청을 처리한다. 워커 스레드를 만들고, 끝나면 모두 정리한다.
+    void run()
+    {
+      std::vector<std::thread> workers;
+      for(unsigned int i = 0; i < nbWorkers; i++) workers.push_back(std::thread([this]() { work(); }));
+
+      std::vector<pollfd> fds;
+      std::vector<uint64_t> ids;
+      while(!stopping.load()) {
+        fds.clear();
+        ids.clear();
+        fds.push_back(pollfd{listenFd, POLLIN, 0});
+        fds.push_back(pollfd{wake[0], POLLIN, 0});
+        for(auto &c : connections) {
+          // 입력이 끝난 연결은 보낼 응답이 있을 때만 기다린다. (끊긴 소켓의 POLLHUP 이 계속 오지 않게)
+          if(c.second.closing && c.second.out.empty()) continue;
+          short events = c.second.closing ? 0 : POLLIN;
+          if(!c.second.out.empty()) events |= POLLOUT;
+          fds.push_back(pollfd{c.second.fd, events, 0});
+          ids.push_back(c.first);
+        }
+        if(poll(&fds[0], fds.size(), -1) < 0 && errno != EINTR) break;
+
+        if(fds[1].revents) finishJobs();
+        if(fds[0].revents) acceptAll();
+        for(size_t i = 2; i < fds.size(); i++) {
+          if(!fds[i].revents) continue;
+          auto it = connections.find(ids[i-2]);
+          if(it == connections.end()) continue;
+          Connection &c = it->second;
+          if(fds[i].revents & (POLLERR | POLLNVAL)) c.dead = true;
+          if(fds[i].revents & (POLLIN | POLLHUP)) receive(it->first, c);
+          if(fds[i].revents & POLLOUT) flush(c);
+        }
+        closeFinished();
+      }
+
+      // 워커는 탐색 한 조각마다 stopping 을 확인하므로 진행 중인 탐색을 버리고 바로 끝난다.
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping.store(true);
+      }
+      jobReady.notify_all();
+      for(auto &w : workers) w.join();
+      for(auto &c : connections) close(c.second.fd);
+      connections.clear();
+    }
+
+    // 서버를 멈춘다. 시그널 핸들러에서 불러도 된다.
+    void stop()
+    {
+      stopping.store(true);
+      if(wake[1] >= 0) {
+        char x = 0;
+        ssize_t r = write(wake[1], &x, 1);
+        (void)r;
+      }
+    }
+
+    // 지금까지 응답한 요청 수
+    unsigned long long requestCount() const
+    {
+      return served;
+    }
+
+    const ResultCache& resultCache() const
+    {
+      return cache;
+    }
+
+    // 워커 솔버의 테이블 크기와 메모리 옵션 (Solver::setTableSize()). run() 전에 부른다.
+    void setTableSize(int logSize, unsigned int flags)
+    {
+      tableLogSize = logSize;
+      tableFlags = flags;
+    }
+
+    private:
+
+    struct Session {
+      Position P;
+      bool over;            // 승리 또는 무승부로 게임이 끝났는지 여부
+      uint64_t connection;  // 세션을 만든 연결
+    };
+
+    struct Connection {
+      int fd;
+      std::string in, out;
+      std::deque<std::string> requests;
+      std::unordered_set<uint64_t> sessions;   // 이 연결이 만든 세션
+      bool busy;      // 워커가 이 연결의 요청을 처리 중
+      bool closing;   // 응답을 모두 보낸 뒤 닫는다 (quit, 입력 종료)
+      bool dead;      // 소켓 오류. 바로 닫는다.
+    };
+
+    enum JobType { BEST, ANALYZE };
+
+    struct Job {
+      uint64_t connection;
+      JobType type;
+      Position P;
+      int millis;     // best 의 제한 시간 (0 이면 제한 없음)
+    };
+
+    struct Done {
+      uint64_t connection;
+      std::string response;
+    };
+
+    int listenFd;
+    int wake[2];      // 워커와 stop() 이 I/O 스레드를 깨우는 파이프
+    std::string unixPath;
+    std::atomic<bool> stopping;
+
+    // I/O 스레드만 사용
+    std::unordered_map<uint64_t, Connection> connections;
+    std::unordered_map<uint64_t, Session> sessions;
+    uint64_t nextConnection, nextSession;
+    unsigned int nbWorkers;
+    unsigned long long served;
+    int tableLogSize;
+    unsigned int tableFlags;
+
+    // 워커와 공유 (mutex 로 보호)
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    std::vector<Done> done;
+
+    // 모든 스레드가 공유 (샤드별 잠금)
+    ResultCache cache;
+
+    static void setNonBlocking(int fd)
+    {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void acceptAll()
+    {
+      for(;;) {
+        int fd = accept(listenFd, 0, 0);
+        if(fd < 0) return;
+        setNonBlocking(fd);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // 유닉스 소켓에서는 무시된다.
+        Connection c;
+        c.fd = fd;
+        c.busy = c.closing = c.dead = false;
+        connections[nextConnection++] = c;
+      }
+    }
+
+    // 받은 데이터를 줄 단위로 나누어 요청 큐에 넣고 처리한다.
+    void receive(uint64_t id, Connection &c)
+    {
+      char buf[4096];
+      for(;;) {
+        ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if(n > 0) {
+          c.in.append(buf, n);
+          continue;
+        }
+        if(n == 0) c.closing = true;
+        else if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) c.dead = true;
+        break;
+      }
+      size_t start = 0, end;
+      while((end = c.in.find('\n', start)) != std::string::npos) {
+        c.requests.push_back(c.in.substr(start, end - start));
+        start = end + 1;
+      }
+      c.in.erase(0, start);
+      if(c.in.size() > MAX_LINE) c.dead = true;
+      process(id, c);
+    }
+
+    // 처리 중인 요청이 없는 동안 큐의 요청을 차례로 처리한다.
+    void process(uint64_t id, Connection &c)
+    {
+      while(!c.busy && !c.requests.empty() && !c.dead) {
+        std::string line = c.requests.front();
+        c.requests.pop_front();
+        if(!line.empty() && line[line.size()-1] == '\r') line.erase(line.size()-1);
+        if(line.empty()) continue;
+        handle(id, c, line);
+      }
+      flush(c);
+    }
+
+    void reply(Connection &c, const std::string &response)
+    {
+      c.out += response;
+      c.out += '\n';
+      served++;
+    }
+
+    // 세션 번호를 읽어 연결 id 의 세션을 찾는다. 없거나 다른 연결의 세션이면 오류 응답을 하고 0 을 리턴한다.
+    Session* findSession(std::istringstream &args, uint64_t id, Connection &c)
+    {
+      uint64_t sid;
+      if(!(args >> sid)) {
+        reply(c, "error missing session");
+        return 0;
+      }
+      auto it = sessions.find(sid);
+      if(it == sessions.end() || it->second.connection != id) {
+        reply(c, "error unknown session");
+        return 0;
+      }
+      return &it->second;
+    }
+
+    // 수순대로 착수한다. 마지막 수가 이기는 수라면 게임을 끝낸다.
+    static bool playMoves(Session &s, const std::string &seq)
+    {
+      for(size_t i = 0; i < seq.size(); i++) {
+        int col = seq[i] - '1';
+        if(s.over || col < 0 || col >= Position::WIDTH || !s.P.canPlay(col)) return false;
+        if(s.P.isWinningMove(col)) {
+          if(i + 1 != seq.size()) return false;
+          s.over = true;
+          return true;
+        }
+        s.P.playCol(col);
+        if(s.P.nbMoves() == Position::WIDTH*Position::HEIGHT) s.over = true;
+      }
+      return true;
+    }
+
+    void handle(uint64_t id, Connection &c, const std::string &line)
+    {
+      std::istringstream args(line);
+      std::string command;
+      args >> command;
+
+      if(command == "new") {
+        std::string seq;
+        args >> seq;
+        if(sessions.size() >= MAX_SESSIONS) return reply(c, "error too many sessions");
+        Session s;
+        s.over = false;
+        s.connection = id;
+        if(!playMoves(s, seq)) return reply(c, "error invalid moves");
+        uint64_t sid = nextSession++;
+        sessions[sid] = s;
+        c.sessions.insert(sid);
+        reply(c, "ok " + std::to_string(sid));
+      } else if(command == "play") {
+        Session *s = findSession(args, id, c);
+        if(!s) return;
+        std::string seq;
+        args >> seq;
+        Session t = *s;
+        if(seq.empty() || !playMoves(t, seq)) return reply(c, "error invalid moves");
+        *s = t;
+        bool full = s->P.nbMoves() == Position::WIDTH*Position::HEIGHT;
+        reply(c, "ok " + std::to_string(s->P.nbMoves() + (s->over && !full)) +
+                 (s->over ? (full ? " draw" : " win") : ""));
+      } else if(command == "best" || command == "analyze") {
+        Session *s = findSession(args, id, c);
+        if(!s) return;
+        if(s->over) return reply(c, "error game over");
+        // best 의 제한 시간은 음이 아닌 정수(밀리초)만 받는다. 잘못된 값을 제한 없음으로 다루지 않는다.
+        int millis = 0;
+        std::string limit;
+        if(command == "best" && args >> limit) {
+          if(limit.size() > 9 || limit.find_first_not_of("0123456789") != std::string::npos)
+            return reply(c, "error invalid time");
+          millis = atoi(limit.c_str());
+        }
+        std::vector<int> scores;
+        if(command == "best") {
+          if(cache.peek(s->P, scores)) return reply(c, bestLine(s->P, scores));
+        } else {
+          // 처음 묻는 포지션만 워커에 넘긴다. 계산이 끝나면 워커가 publish() 하고, 기다리던 요청도 그때 답한다.
+          ResultCache::Lookup found = cache.lookup(s->P, scores, [this, id](bool ok, const std::vector<int> &r) {
+            finish(id, ok ? analyzeLine(r) : "error cancelled");
+          });
+          if(found == ResultCache::HIT) return reply(c, analyzeLine(scores));
+          if(found == ResultCache::JOINED) {
+            c.busy = true;
+            return;
+          }
+        }
+        Job job = {id, command == "best" ? BEST : ANALYZE, s->P, millis > 0 ? millis : 0};
+        c.busy = true;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          jobs.push_back(job);
+        }
+        jobReady.notify_one();
+      } else if(command == "close") {
+        uint64_t sid;
+        if(!(args >> sid) || !c.sessions.erase(sid)) return reply(c, "error unknown session");
+        sessions.erase(sid);
+        reply(c, "ok");
+      } else if(command == "stats") {
+        std::ostringstream out;
+        out << "ok " << served << ' ' << cache.hitCount() << ' ' << cache.missCount() << ' '
+            << cache.coalescedCount() << ' ' << cache.evictionCount() << ' ' << cache.size();
+        reply(c, out.str());
+      } else if(command == "quit") {
+        reply(c, "ok");
+        c.closing = true;
+        c.requests.clear();
+      } else {
+        reply(c, "error unknown command");
+      }
+    }
+
+    // 보낼 수 있는 만큼 응답을 보낸다. 나머지는 POLLOUT 에서 보낸다.
+    void flush(Connection &c)
+    {
+      while(!c.out.empty() && !c.dead) {
+        ssize_t n = send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+        if(n > 0) c.out.erase(0, n);
+        else {
+          if(n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) c.dead = true;
+          break;
+        }
+      }
+    }
+
+    // 워커가 끝낸 작업의 응답을 연결에 붙이고, 그 연결의 다음 요청을 처리한다.
+    void finishJobs()
+    {
+      char buf[256];
+      while(read(wake[0], buf, sizeof(buf)) > 0) {}
+      std::vector<Done> finished;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(done);
+      }
+      for(Done &d : finished) {
+        auto it = connections.find(d.connection);
+        if(it == connections.end()) continue;
+        it->second.busy = false;
+        reply(it->second, d.response);
+        process(it->first, it->second);
+      }
+    }
+
+    // 입력이 끝났고 보낼 응답도 없거나, 오류가 난 연결을 닫는다. 연결의 세션도 함께 닫는다.
+    void closeFinished()
+    {
+      for(auto it = connections.begin(); it != connections.end();) {
+        Connection &c = it->second;
+        if(c.dead || (c.closing && !c.busy && c.out.empty() && c.requests.empty())) {
+          for(uint64_t sid : c.sessions) sessions.erase(sid);
+          close(c.fd);
+          it = connections.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    // 워커 스레드. 자신의 솔버로 작업 큐의 탐색 요청을 처리한다.
+    // 진행 중인 요청이 있으면 기다리지 않고 큐를 확인해 한 조각마다 새 요청을 하나씩 스케줄러에 넣는다.
+    void work()
+    {
+      Solver solver;
+      if(tableLogSize != Solver::TABLE_LOG_SIZE || tableFlags) solver.setTableSize(tableLogSize, tableFlags);
+      SearchScheduler scheduler(solver);
+      for(;;) {
+        Job job;
+        bool received = false;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          if(scheduler.empty()) jobReady.wait(lock, [this]() { return stopping.load() || !jobs.empty(); });
+          if(stopping.load()) return;
+          if(!jobs.empty()) {
+            job = jobs.front();
+            jobs.pop_front();
+            received = true;
+          }
+        }
+        if(received) {
+          uint64_t connection = job.connection;
+          scheduler.add(job.P, job.type == BEST ? SearchScheduler::Search::BEST : SearchScheduler::Search::ANALYZE,
+                        [this, connection](SearchScheduler::Search &s) {
+                          if(s.getKind() == SearchScheduler::Search::ANALYZE) {
+                            if(s.wasStopped()) cache.abandon(s.position());
+                            else cache.publish(s.position(), s.scores());
+                          }
+                          finish(connection, response(s));
+                        },
+                        job.millis > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(job.millis) :
+                                         std::chrono::steady_clock::time_point::max());
+        }
+        scheduler.step();
+      }
+    }
+
+    // 끝난 요청의 응답을 I/O 스레드에 넘긴다.
+    void finish(uint64_t connection, const std::string &response)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.push_back(Done{connection, response});
+      }
+      char x = 0;
+      ssize_t r = write(wake[1], &x, 1);
+      (void)r;
+    }
+
+    // best 는 solve(P, deadline), analyze 는 Solver::analyze() 와 같은 결과이다.
+    static std::string response(const SearchScheduler::Search &s)
+    {
+      if(s.getKind() == SearchScheduler::Search::ANALYZE) return analyzeLine(s.scores());
+      const Solver::SearchResult &r = s.result();
+      std::ostringstream out;
+      out << "ok " << r.bestMove + 1 << ' ' << r.lower << ' ' << r.upper;
+      return out.str();
+    }
+
+    static std::string analyzeLine(const std::vector<int> &scores)
+    {
+      std::ostringstream out;
+      out << "ok";
+      for(int score : scores) {
+        if(score == Solver::INVALID_MOVE) out << " -";
+        else out << ' ' << score;
+      }
+      return out.str();
+    }
+
+    // 컬럼별 점수로 만든 best 응답. 점수가 같으면 중앙에 가까운 컬럼을 고른다.
+    static std::string bestLine(const Position &P, const std::vector<int> &scores)
+    {
+      int best = -1;
+      for(int col : CenterOrder<Position>::columns)
+        if(P.canPlay(col) && (best < 0 || scores[col] > scores[best])) best = col;
+      std::ostringstream out;
+      out << "ok " << best + 1 << ' ' << scores[best] << ' ' << scores[best];
+      return out.str();
+    }
+  };
+
+}}
+
+#endif
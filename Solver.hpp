@@ -0,0 +1,774 @@
+/*
+ * This file is part of Connect4 Game Solver <http://connect4.gamesolver.org>
+ * Copyright (C) 2007 Pascal Pons <contact@gamesolver.org>
+ *
+ * Connect4 Game Solver is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Connect4 Game Solver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Connect4 Game Solver. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <type_traits>
+#include "position.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveSorter.hpp"
+#include "ThreadPool.hpp"
+#include "SearchStats.hpp"
+
+/*
+// Connect4 Game Solver 메인 로직 커스텀 코드 by 채희재
+//
+// 오리지널 Connect4 Game Solver 의 지향점은 제한된 Depth 기반의 서치가 아닌 풀 서치이다.
+// 2018 인공지능 수업에서 다루었던 단순 미니맥스, 알파베타 프루닝 구현에서 그치지 않고,
+//
+//   중앙일수록 유리하다는 휴리스틱 기반의 트리 탐색 순서 지정을 통해 프루닝 성능 향상,
+//   해시 테이블 기반의 캐쉬를 두어 퍼포먼스 향상,
+//   본인의 다음 수 예측을 통한 프루닝 성능 향상,
+//   비트마스킹을 통한 추가 연산에 따른 추가 소요 시간 최소화
+//   (1~2수를 미리 예측해 프루닝을 하는 것이 프루닝없이 추가적인 탐색을 하는 것보다 효율적)
+//
+// 를 통해 굉장히 오래걸리는 풀 서치를 아주 단시간내에 실현한다.
+// 승리&&패배&&무승부만 체크하는 weak solver로 스코어를 계산할 경우 추가 성능 향상이 가능하나
+// 수 예측을 통한 성능 향상만큼 비약적인 성능 향상이 아닌 아주 미미한 성능 향상이고,
+// <http://connect4.gamesolver.org/> 에서처럼 휴리스틱을 출력하기 위해 strong solver를 사용했다.
+//
+// 멀티스레드 탐색 (Lazy SMP)
+//   setThreads(n) 으로 n > 1 을 지정하면 solve() 호출 시 n-1 개의 보조 스레드가
+//   같은 루트를 서로 다른 컬럼 순서로 동시에 탐색하며, 트랜스포지션 테이블 하나를 공유한다.
+//   보조 스레드는 테이블을 채워 메인 스레드의 프루닝을 돕는 역할만 하고,
+//   결과는 항상 메인 스레드의 탐색 결과를 사용한다.
+//   메인 스레드가 끝나면 stop 플래그로 보조 스레드를 중단시킨다.
+//
+// 루트 병렬 분석 (analyze)
+//   착수 가능한 모든 컬럼의 점수를 스레드 풀에서 동시에 계산한다.
+//   컬럼별로 순서대로 solve() 를 부르면 7개 자식 탐색 시간의 합이 걸리지만,
+//   analyze() 는 가장 오래 걸리는 자식 하나의 시간 정도에 끝난다.
+//
+// 시간 제한 탐색 (solve(P, deadline))
+//   먼저 승/무/패를 확정한 뒤 이분 탐색으로 점수 범위를 점점 좁혀 간다.
+//   노드 4096개마다 시간을 확인하고, 시간이 다 되거나 cancel() 이 호출되면 stop 플래그로 탐색을 멈춘 뒤
+//   그때까지 증명된 점수 범위와 최선의 수를 돌려준다. 따라서 몇 번째 수이든 응답 시간이 보장된다.
+//
+// 최선의 수 저장과 예상 수순 (principalVariation())
+//   테이블 값에 점수 상한/하한과 함께 그 포지션에서 가장 좋았던(또는 베타 컷을 낸) 컬럼을 저장하고,
+//   다음에 같은 포지션을 만나면 그 컬럼을 가장 먼저 탐색한다.
+//   대칭 키를 사용할 때는 키와 같은 방향(좌우를 뒤집은 쪽)의 컬럼 번호로 저장한다.
+//
+// 킬러/히스토리 수 정렬 (setMoveHistory())
+//   베타 컷을 낸 컬럼(킬러)과 (플레이어, 칸)별 컷 횟수(히스토리)를 탐색 스레드마다 모아
+//   MoveSorter 에서 moveScore 가 같은 수들의 순서를 정한다. 기본은 꺼져 있다.
+//
+// 탐색 통계 (getStats())
+//   탐색 스레드마다 SearchStats 를 따로 모으고, solve() 가 끝나면 메인 스레드의 통계를 남긴다.
+//   SOLVER_STATS=0 으로 빌드하면 노드 수 외의 통계 코드는 컴파일되지 않는다.
+//
+// 테이블 크기와 메모리 (setTableSize())
+//   기본 64MB 테이블을 실행 중에 수 GB 로 키울 수 있다. 큰 테이블은 무작위 버킷 접근의 TLB 미스를 줄이려고
+//   huge page 로 할당하고, 여러 소켓의 스레드가 함께 쓸 때는 NUMA 노드에 번갈아 배치한다.
+//   비우기(reset())는 여러 스레드가 나누어 한다. 효과 측정은 C4Bench --table.
+//   negamax 는 수를 정렬하면서 자식 포지션들의 버킷을 미리 캐시로 불러와(setPrefetch()), 첫 자식을 탐색하는 동안
+//   나머지 자식의 메모리 접근이 끝나 있게 한다. C4Bench --no-prefetch 와 비교한다.
+//
+// 게임 중 테이블 재사용 (beginMove())
+//   한 게임 동안 테이블을 비우지 않고 수마다 세대를 올린다. 교체할 엔트리는 이전 세대의 것부터 고르고,
+//   현재 포지션보다 적게 둔 포지션의 엔트리는 다시 쓰일 일이 없으므로 지운다.
+//
+// 보드 크기 (BasicSolver<W, H>)
+//   포지션, 수 정렬, 테이블 키 크기와 중앙 우선 컬럼 순서가 모두 보드 크기에서 컴파일 시점에 정해진다.
+//   Solver 는 7X6 이고, 배치 모드의 --size 로 6x5, 8x7, 9x7 솔버를 고를 수 있다.
+//   64칸을 넘는 보드(9X7)는 128비트 비트보드와 128비트 키를 사용하고, 64칸 이하의 보드는 기존 64비트 코드 그대로다.
+//
+// 이어서 진행하는 탐색 (Resumable, ResumableSearch.hpp)
+//   negamax() 와 같은 탐색을 명시적 스택으로 진행해 노드 수 단위로 멈췄다가 이어서 진행할 수 있다.
+//   SearchScheduler 가 이를 이용해 스레드 하나에서 여러 탐색을 번갈아 진행한다. (서버 모드의 워커)
+//   재귀 탐색인 negamax() 가 더 빠르므로 solve()/analyze() 는 그대로 negamax() 를 사용한다.
+//
+*/
+
+namespace GameSolver { namespace Connect4 {
+
+  // 보드 크기(W x H)별로 컴파일되는 솔버. 대회 규격(7X6)은 Solver 를 사용한다.
+  template<int W, int H>
+  class BasicSolver {
+    public:
+
+    typedef BasicPosition<W, H> Position;
+    typedef BasicMoveSorter<Position> MoveSorter;
+    typedef BasicMoveHistory<Position> MoveHistory;
+    typedef typename Position::bitboard_t bitboard_t;
+
+    // 해싱을 위한 테이블의 기본 크기는 64MB (64바이트 버킷 2^20 개). setTableSize() 로 더 크게 바꿀 수 있다.
+    static const int TABLE_LOG_SIZE = 20;
+
+    // 키는 보드 크기만큼의 비트(7X6 에서 7 x 7 = 49비트, 9X7 에서 9 x 8 = 72비트)를 사용한다.
+    // 버킷 인덱스 20비트를 제외한 나머지(7X6 에서 29비트)만 저장하면 되므로,
+    // 그 비트 수가 들어가는 가장 작은 타입을 저장 키로 사용한다. 키가 작을수록 버킷에 엔트리가 많이 들어간다.
+    // 값은 점수 상한/하한 6비트씩과 최선의 컬럼 3~4비트를 담기 위해 16비트를 사용한다.
+    static const int KEY_SIZE = Position::WIDTH*(Position::HEIGHT+1);
+    typedef typename std::conditional<KEY_SIZE - TABLE_LOG_SIZE <= 16, uint16_t,
+            typename std::conditional<KEY_SIZE - TABLE_LOG_SIZE <= 32, uint32_t, uint64_t>::type>::type StoredKey;
+    typedef TranspositionTable<StoredKey, uint16_t, KEY_SIZE, TABLE_LOG_SIZE> Table;
+    static_assert(Position::WIDTH*Position::HEIGHT - 2 <= int(Table::MAX_DEPTH), "depths do not fit in the table");
+
+    private:
+
+    // 테이블 값 구성 : 하위 6비트는 점수 상한 - MIN_SCORE + 1 (항상 0 보다 크다),
+    //                  그 위 3비트(폭이 8 이상이면 4비트)는 최선의 컬럼 + 1 (0 이면 없음),
+    //                  그 위 6비트는 점수 하한 - MIN_SCORE + 1 (0 이면 없음)
+    // 널 윈도우 탐색은 fail-high 로 끝나는 경우가 많으므로, 하한도 저장해 두어야
+    // 이분 탐색의 다음 단계에서 같은 하한을 다시 증명하지 않는다.
+    static const int SCORE_BITS = 6;
+    static const int MOVE_BITS = Position::WIDTH < 8 ? 3 : 4;
+    static const unsigned int SCORE_MASK = (1 << SCORE_BITS) - 1;
+    static const int LOWER_SHIFT = SCORE_BITS + MOVE_BITS;
+    static_assert((Position::WIDTH*Position::HEIGHT+1)/2 - Position::MIN_SCORE + 1 <= int(SCORE_MASK), "scores do not fit in the table value");
+    static_assert(SCORE_BITS + MOVE_BITS + SCORE_BITS <= 16, "table value does not fit in 16 bits");
+
+    // 테이블에 하한이 없음을 나타내는 값
+    static const int NO_BOUND = -1000;
+
+    // 테이블에서 가져온 수를 가장 먼저 탐색하도록 MoveSorter 에 넘기는 점수
+    static const int TABLE_MOVE_SCORE = 1000;
+
+    static uint16_t packValue(int upper, int lower, int col, bool mirrored)
+    {
+      if(col >= 0 && mirrored) col = Position::WIDTH-1 - col;
+      unsigned int l = lower >= Position::MIN_SCORE ? lower - Position::MIN_SCORE + 1 : 0;
+      return uint16_t((upper - Position::MIN_SCORE + 1) | (col + 1) << SCORE_BITS | l << LOWER_SHIFT);
+    }
+
+    static int valueUpper(unsigned int val)
+    {
+      return int(val & SCORE_MASK) + Position::MIN_SCORE - 1;
+    }
+
+    static int valueLower(unsigned int val)
+    {
+      unsigned int l = val >> LOWER_SHIFT & SCORE_MASK;
+      return l ? int(l) + Position::MIN_SCORE - 1 : NO_BOUND;
+    }
+
+    static int valueMove(unsigned int val, bool mirrored)
+    {
+      int col = int(val >> SCORE_BITS & ((1 << MOVE_BITS) - 1)) - 1;
+      return col >= 0 && mirrored ? Position::WIDTH-1 - col : col;
+    }
+
+
+    typedef std::chrono::steady_clock Clock;
+
+    // 탐색 스레드 하나가 사용하는 상태.
+    // table : 해당 스레드가 사용하는 트랜스포지션 테이블
+    // order : 해당 스레드의 컬럼 탐색 순서
+    // abortable : 중단 가능 여부. 보조 스레드와 시간 제한 탐색은 stop 플래그가 켜지면 탐색을 중단한다.
+    // deadline : 시간 제한 탐색의 마감 시각 (없으면 0)
+    // stats : 해당 스레드의 탐색 통계
+    // history : 해당 스레드의 킬러/히스토리 (moveHistory 가 켜져 있을 때만 사용)
+    struct Worker {
+      Table *table;
+      const int *order;
+      bool abortable;
+      const Clock::time_point *deadline;
+      SearchStats stats;
+      MoveHistory history;
+
+      Worker(Table *table, const int *order, bool abortable, const Clock::time_point *deadline = 0):
+        table{table}, order{order}, abortable{abortable}, deadline{deadline}
+      {
+        stats.clear();
+      }
+    };
+
+    // 중앙 우선 컬럼 순서 (7X6 에서 3, 4, 2, 5, 1, 6, 0)
+    typedef CenterOrder<Position> ColumnOrder;
+    Table transTable;
+
+    unsigned int nbThreads;
+    bool symmetry;
+    bool moveHistory;
+    bool prefetch;
+    bool trackReuse;  // beginMove() 가 불린 뒤로 이전 수의 엔트리 재사용을 센다.
+    std::atomic<bool> stop;
+    SearchStats lastStats;
+
+    // analyze() 에서 컬럼별 탐색을 돌릴 스레드 풀. 처음 사용할 때 만든다.
+    std::unique_ptr<ThreadPool> pool;
+
+    // 수 move 를 둔 자식 포지션의 테이블 버킷을 미리 캐시로 불러온다.
+    // 정렬이 끝난 뒤 첫 자식을 탐색하는 동안 나머지 자식의 메모리 접근이 함께 진행된다.
+    POSITION_INLINE void prefetchChild(const Position &P, bitboard_t move, const Worker &w) const
+    {
+      Position P2(P);
+      P2.play(move);
+      w.table->prefetch(symmetry ? P2.canonicalKey() : P2.key());
+    }
+
+    // 현재까지 둔 수의 모음을 P라고 할 때 다음 착수를 위한 최적의 점수를 구함.
+    // CPU 에 맞는 복제본이 선택되며, 재귀 호출은 같은 복제본을 직접 호출한다.
+    POSITION_MULTIVERSION
+    int negamax(const Position &P, int alpha, int beta, Worker &w) {
+      assert(alpha < beta);
+      assert(!P.canWinNext());
+
+      w.stats.nodes++;
+      SOLVER_STAT(w.stats.depthNodes[P.nbMoves()]++);
+
+      // 노드 4096개마다 마감 시각을 확인한다.
+      if(w.deadline && (w.stats.nodes & 4095) == 0 && Clock::now() >= *w.deadline)
+        stop.store(true, std::memory_order_relaxed);
+
+      // 지지 않는 가능한 수를 마킹한 비트를 구한다.
+      bitboard_t next = P.possibleNonLosingMoves();
+
+      // 단 1곳도 없다면, 내 착수를 발판으로 상대가 나를 이긴다.
+      if(next == 0) {
+        return -(Position::WIDTH*Position::HEIGHT - P.nbMoves())/2;
+      }
+
+      // 이미 모든 수 - 2 이상 뒀다면 무승부(바로 윗 조건으로 인해 42번째 수 도달 전에 무승부 여부 파악)
+      if(P.nbMoves() >= Position::WIDTH*Position::HEIGHT - 2) {
+        return 0;
+      }
+
+      // 단순 미니맥스, 알파베타가 아닌 수 예측 기반이므로 알파 & 베타값을 계속해서 조정
+      int min = -(Position::WIDTH*Position::HEIGHT-2 - P.nbMoves())/2;
+      if(alpha < min) {
+        alpha = min;
+        // 프루닝
+        if(alpha >= beta) return alpha;
+      }
+
+      int max = (Position::WIDTH*Position::HEIGHT-1 - P.nbMoves())/2;
+
+      // 대칭 사용 시 좌우 대칭인 포지션은 테이블의 같은 엔트리를 사용한다.
+      bool mirrored = false;
+      bitboard_t key = symmetry ? P.canonicalKey(mirrored) : P.key();
+      int tableMove = -1;
+      int lower = NO_BOUND;
+      SOLVER_STAT(w.stats.ttProbes++);
+      if(unsigned int val = w.table->get(key)) {
+        // 게임 중(beginMove() 이후)에만 이전 수의 엔트리인지 한 번 더 확인한다.
+        SOLVER_STAT(w.stats.ttHits++; if(trackReuse && w.table->isPrevious(key)) w.stats.ttPreviousHits++);
+        max = valueUpper(val);
+        lower = valueLower(val);
+        tableMove = valueMove(val, mirrored);
+        // 저장된 하한으로 알파를 올린다.
+        if(alpha < lower) {
+          alpha = lower;
+          // 프루닝
+          if(alpha >= beta) return alpha;
+        }
+      }
+
+      if(beta > max) {
+        beta = max;                     // there is no need to keep beta above our max possible score.
+        // 프루닝
+        if(alpha >= beta) return beta;  // prune the exploration if the [alpha;beta] window is empty.
+      }
+
+      // 단순 탐색이 아닌 포지션 스코어 기반으로 트리 탐색 순서 조정.
+      MoveSorter moves(moveHistory ? &w.history : 0, P.nbMoves());
+
+      // 데이터 삽입. 테이블에 저장된 최선의 수는 가장 먼저 탐색한다.
+      for(int i = Position::WIDTH; i--;) {
+        if(bitboard_t move = next & Position::column_mask(w.order[i])) {
+          moves.add(move, w.order[i] == tableMove ? TABLE_MOVE_SCORE : P.moveScore(move));
+          if(prefetch) prefetchChild(P, move, w);
+        }
+      }
+
+      // 데이터 추출
+      int moveIndex = 0;
+      int bestMove = tableMove;
+      while(bitboard_t next = moves.getNext()) {
+        // 상대방의 착수. 미니맥스 원리로 상대방 스코어의 역수를 사용한다.
+        Position P2(P);
+        P2.play(next);
+        int score = -negamax(P2, -beta, -alpha, w);
+
+        // 중단된 탐색의 결과는 신뢰할 수 없으므로 테이블에 남기지 않고 바로 빠져나간다.
+        if(w.abortable && stop.load(std::memory_order_relaxed)) return 0;
+
+        // 프루닝
+        if(score >= beta) {
+          SOLVER_STAT(w.stats.cutoffs++; if(moveIndex == 0) w.stats.firstMoveCutoffs++);
+          if(moveHistory) w.history.cutoff(P.nbMoves(), next);
+          // 컷을 낸 수와 새 하한을 기록한다. 상한은 이미 알고 있던 max 를 그대로 둔다.
+          if(w.table->put(key, packValue(max, score > lower ? score : lower, Position::moveColumn(next), mirrored), P.nbMoves()))
+            SOLVER_STAT(w.stats.ttOverwrites++);
+          SOLVER_STAT(w.stats.ttStores++);
+          return score;
+        }
+        if(score > alpha) {
+          alpha = score;
+          bestMove = Position::moveColumn(next);
+        }
+        moveIndex++;
+      }
+
+      // 해싱을 통해 퍼포먼스 향상
+      if(w.table->put(key, packValue(alpha, lower, bestMove, mirrored), P.nbMoves()))
+        SOLVER_STAT(w.stats.ttOverwrites++);
+      SOLVER_STAT(w.stats.ttStores++);
+      return alpha;
+    }
+
+    // 널 윈도우 탐색을 반복하며 점수 범위를 좁혀가는 이분 탐색.
+    int search(const Position &P, bool weak, Worker &w)
+    {
+      int min = -(Position::WIDTH*Position::HEIGHT - P.nbMoves())/2;
+      int max = (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+      if(weak) {
+        min = -1;
+        max = 1;
+      }
+
+      while(min < max) {
+        int med = min + (max - min)/2;
+        if(med <= 0 && min/2 < med) med = min/2;
+        else if(med >= 0 && max/2 > med) med = max/2;
+        SOLVER_STAT(w.stats.nullWindowSearches++);
+        int r = negamax(P, med, med + 1, w);
+        if(w.abortable && stop.load(std::memory_order_relaxed)) break;
+        if(r <= med) max = r;
+        else min = r;
+      }
+      return min;
+    }
+
+    // 바로 이길 수 있는 경우를 먼저 처리한 뒤 search() 로 점수를 구한다.
+    int solveWith(const Position &P, bool weak, Worker &w)
+    {
+      // 리커젼 탈출 조건으로 승리 여부 체크
+      if(P.canWinNext())
+        return (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+      return search(P, weak, w);
+    }
+
+    // 보조 스레드 t 의 컬럼 순서. 중앙 우선 순서를 t 만큼 회전시켜 스레드마다 다른 가지부터 탐색하게 한다.
+    void helperOrder(unsigned int t, int order[Position::WIDTH]) const
+    {
+      for(int i = 0; i < Position::WIDTH; i++)
+        order[i] = ColumnOrder::columns[(i + t) % Position::WIDTH];
+    }
+
+    // Lazy SMP 보조 스레드 nbThreads-1 개를 시작한다. 보조 스레드는 stop 플래그가 켜질 때까지 P 를 탐색한다.
+    void startHelpers(const Position &P, bool weak, std::vector<std::thread> &helpers,
+                      std::vector<std::vector<int> > &orders)
+    {
+      orders.resize(nbThreads);
+      for(unsigned int t = 1; t < nbThreads; t++) {
+        orders[t].resize(Position::WIDTH);
+        helperOrder(t, &orders[t][0]);
+        helpers.push_back(std::thread([this, P, weak, &orders, t]() {
+          Worker w(&transTable, &orders[t][0], true);
+          search(P, weak, w);
+        }));
+      }
+    }
+
+    void stopHelpers(std::vector<std::thread> &helpers)
+    {
+      stop.store(true);
+      for(auto &h : helpers) h.join();
+    }
+
+    // 루트에서의 널 윈도우 탐색. 점수가 med 보다 큰 컬럼을 찾으면 best 에 기록하고 그 점수를 리턴한다.
+    // 모든 컬럼이 med 이하라면 med 를 리턴한다.
+    int rootProbe(const Position &P, const std::vector<int> &cols, int med, Worker &w, int &best)
+    {
+      for(int col : cols) {
+        Position P2(P);
+        P2.playCol(col);
+        int score = -negamax(P2, -(med + 1), -med, w);
+        if(stop.load(std::memory_order_relaxed)) return med;
+        if(score > med) {
+          best = col;
+          return score;
+        }
+      }
+      return med;
+    }
+
+    public:
+
+    // 시간 제한 탐색의 결과.
+    // 점수는 [lower, upper] 범위 안에 있음이 증명되었고, bestMove 는 lower 이상의 점수를 보장하는 컬럼이다.
+    // complete 가 true 면 lower == upper 로 점수가 확정된 것이다.
+    struct SearchResult {
+      int lower;
+      int upper;
+      int bestMove;
+      bool complete;
+    };
+
+    // analyze() 결과에서 착수할 수 없는 컬럼을 나타내는 값
+    static const int INVALID_MOVE = -1000;
+
+    // 노드 수 단위로 나누어 진행하는 탐색. 정의는 ResumableSearch.hpp 에 있다.
+    class Resumable;
+
+    void reset()
+    {
+      transTable.reset();
+    }
+
+    // 트랜스포지션 테이블을 파일로 저장하고, 다음 실행 때 불러와 이전 탐색 결과를 이어서 사용한다.
+    // 보드 크기나 테이블 형식이 다르거나 체크섬이 맞지 않는 파일은 불러오지 않는다.
+    bool saveTable(const std::string &path) const
+    {
+      return transTable.save(path.c_str(), Position::WIDTH, Position::HEIGHT);
+    }
+
+    bool loadTable(const std::string &path)
+    {
+      return transTable.load(path.c_str(), Position::WIDTH, Position::HEIGHT);
+    }
+
+    /**
+     * 게임 중 한 수의 탐색을 시작하기 전에 부른다. 이전 수들의 테이블 엔트리를 이어서 사용한다.
+     * 테이블의 세대를 올려서 이전 수에서 저장된 엔트리가 먼저 교체되게 하고,
+     * prune 이 true 면 P 보다 적게 둔 포지션(P 이후로는 나올 수 없는)의 엔트리를 지운다.
+     * 이후 탐색의 getStats().ttPreviousHits 가 이전 수들의 탐색에서 재사용한 조회 횟수가 된다.
+     * @return 지운 엔트리 개수
+     */
+    uint64_t beginMove(const Position &P, bool prune = true)
+    {
+      transTable.nextGeneration();
+      trackReuse = true;
+      return prune ? transTable.prune(P.nbMoves()) : 0;
+    }
+
+    // 탐색에 사용할 스레드 수를 지정한다. 1 이면 기존 단일 스레드 탐색과 동일하다.
+    void setThreads(unsigned int n)
+    {
+      nbThreads = n ? n : 1;
+    }
+
+    unsigned int getThreads() const
+    {
+      return nbThreads;
+    }
+
+    // 좌우 대칭 포지션을 테이블에서 같은 키로 다룰지 여부 (기본 true)
+    void setSymmetry(bool on)
+    {
+      symmetry = on;
+    }
+
+    // 킬러/히스토리 휴리스틱을 수 정렬에 섞을지 여부 (기본 false)
+    void setMoveHistory(bool on)
+    {
+      moveHistory = on;
+    }
+
+    bool getMoveHistory() const
+    {
+      return moveHistory;
+    }
+
+    // 자식 포지션의 테이블 버킷을 탐색 전에 미리 불러올지 여부 (기본 true)
+    void setPrefetch(bool on)
+    {
+      prefetch = on;
+    }
+
+    /**
+     * 트랜스포지션 테이블을 버킷 2^logSize 개(64 x 2^logSize 바이트)로 다시 할당하고 비운다.
+     * 큰 테이블(수 GB)에서는 flags 로 huge page 와 NUMA 노드 인터리브를 지정한다. (Table::HUGETLB_PAGES 등)
+     * @return logSize 가 TABLE_LOG_SIZE 보다 작거나 메모리가 부족하면 false 이고, 테이블은 그대로 남는다.
+     */
+    bool setTableSize(int logSize, unsigned int flags = 0)
+    {
+      return transTable.resize(logSize, flags);
+    }
+
+    int getTableLogSize() const
+    {
+      return transTable.getLogSize();
+    }
+
+    // 테이블 메모리의 페이지 종류 ("hugetlb", "thp", "small", "default", "file")
+    const char* getTablePages() const
+    {
+      return transTable.getPages();
+    }
+
+    bool isTableInterleaved() const
+    {
+      return transTable.isInterleaved();
+    }
+
+    // 테이블에서 사용 중인 엔트리 개수
+    uint64_t getTableOccupancy() const
+    {
+      return transTable.occupancy();
+    }
+
+    // 마지막 solve() 호출에서 메인 스레드가 방문한 노드 수 (analyze() 는 모든 컬럼의 합)
+    unsigned long long getNodeCount() const
+    {
+      return lastStats.nodes;
+    }
+
+    // 마지막 탐색에서 테이블 조회가 성공한 횟수 (SOLVER_STATS=0 이면 0)
+    unsigned long long getHitCount() const
+    {
+      return lastStats.ttHits;
+    }
+
+    // 마지막 탐색의 전체 통계. getNodeCount() 와 같은 기준으로 모은다.
+    const SearchStats& getStats() const
+    {
+      return lastStats;
+    }
+
+    int solve(const Position &P, bool weak = false)
+    {
+      lastStats.clear();
+      // 리커젼 탈출 조건으로 승리 여부 체크
+      if(P.canWinNext())
+        return (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+
+      stop.store(false);
+      std::vector<std::thread> helpers;
+      std::vector<std::vector<int> > orders;
+      startHelpers(P, weak, helpers, orders);
+
+      Worker w(&transTable, ColumnOrder::columns, false);
+      int score = search(P, weak, w);
+
+      stopHelpers(helpers);
+      lastStats = w.stats;
+      return score;
+    }
+
+    /**
+     * 마감 시각까지만 탐색한다.
+     * 먼저 승/무/패를 가리고(0, -1 기준 널 윈도우) 그 다음 이분 탐색으로 점수 범위를 좁힌다.
+     * 마감 시각이 지나거나 cancel() 이 호출되면 그때까지 증명된 범위와 최선의 수를 리턴한다.
+     * solve() 는 시작할 때 stop 을 지우므로, 다른 스레드의 cancel() 이 그보다 먼저 불리면 취소가 사라진다.
+     * 이를 막으려면 취소하는 쪽이 cancelled 를 켠 뒤 cancel() 을 부른다. 켜져 있으면 탐색을 시작하지 않는다.
+     */
+    SearchResult solve(const Position &P, Clock::time_point deadline, const std::atomic<bool> *cancelled = 0)
+    {
+      const int n = P.nbMoves();
+      SearchResult r = {-(Position::WIDTH*Position::HEIGHT - n)/2, (Position::WIDTH*Position::HEIGHT+1 - n)/2, -1, false};
+      lastStats.clear();
+
+      // 바로 이기는 수가 있다면 탐색할 필요가 없다.
+      for(int col : ColumnOrder::columns) {
+        if(P.canPlay(col) && P.isWinningMove(col)) {
+          r.lower = r.upper = (Position::WIDTH*Position::HEIGHT+1 - n)/2;
+          r.bestMove = col;
+          r.complete = true;
+          return r;
+        }
+      }
+
+      // 지지 않는 수를 negamax 와 같은 순서로 정렬해 둔다. 첫 번째 수가 증명 전까지의 기본 추천 수가 된다.
+      bitboard_t next = P.possibleNonLosingMoves();
+      std::vector<int> cols;
+      MoveSorter moves;
+      for(int i = Position::WIDTH; i--;)
+        if(bitboard_t move = next & Position::column_mask(ColumnOrder::columns[i]))
+          moves.add(move, P.moveScore(move));
+      while(bitboard_t move = moves.getNext())
+        for(int col = 0; col < Position::WIDTH; col++)
+          if(move & Position::column_mask(col)) cols.push_back(col);
+
+      if(cols.empty()) {
+        // 어디에 두어도 다음 수에 진다.
+        for(int col : ColumnOrder::columns)
+          if(P.canPlay(col)) {
+            r.bestMove = col;
+            break;
+          }
+        r.lower = r.upper = -(Position::WIDTH*Position::HEIGHT - n)/2;
+        r.complete = true;
+        return r;
+      }
+      r.bestMove = cols[0];
+      if(n >= Position::WIDTH*Position::HEIGHT - 2) {
+        r.lower = r.upper = 0;
+        r.complete = true;
+        return r;
+      }
+      r.lower = -(Position::WIDTH*Position::HEIGHT-2 - n)/2;
+      r.upper = (Position::WIDTH*Position::HEIGHT-1 - n)/2;
+
+      // stop 을 지운 뒤에 확인하므로, 확인 이후의 취소는 뒤따르는 cancel() 이 stop 을 다시 켠다.
+      stop.store(false);
+      if(cancelled && cancelled->load()) return r;
+      std::vector<std::thread> helpers;
+      std::vector<std::vector<int> > orders;
+      startHelpers(P, false, helpers, orders);
+
+      Worker w(&transTable, ColumnOrder::columns, true, &deadline);
+      bool proven = false; // bestMove 가 lower 이상임이 증명되었는지 여부
+      while(r.lower < r.upper) {
+        int med;
+        if(r.lower <= 0 && 0 < r.upper) med = 0;          // 이기는가?
+        else if(r.lower <= -1 && -1 < r.upper) med = -1;  // 비기는가?
+        else {
+          med = r.lower + (r.upper - r.lower)/2;
+          if(med <= 0 && r.lower/2 < med) med = r.lower/2;
+          else if(med >= 0 && r.upper/2 > med) med = r.upper/2;
+        }
+        int best = -1;
+        SOLVER_STAT(w.stats.nullWindowSearches++);
+        int v = rootProbe(P, cols, med, w, best);
+        if(stop.load(std::memory_order_relaxed)) break;
+        if(v <= med) r.upper = v;
+        else {
+          r.lower = v;
+          r.bestMove = best;
+          proven = true;
+        }
+      }
+
+      // 점수는 확정되었지만 그 점수를 내는 수를 아직 찾지 못한 경우 (모든 탐색이 fail-low 였던 경우)
+      if(r.lower == r.upper && !proven && !stop.load(std::memory_order_relaxed)) {
+        int best = -1;
+        rootProbe(P, cols, r.lower - 1, w, best);
+        if(best >= 0) r.bestMove = best;
+      }
+
+      stopHelpers(helpers);
+      r.complete = r.lower == r.upper;
+      lastStats = w.stats;
+      return r;
+    }
+
+    /**
+     * P 이후 양쪽이 최선을 다했을 때의 예상 수순을 구한다.
+     * 테이블에 저장된 수를 따라가고, 엔트리가 없거나(덮어써졌거나) 수가 저장되지 않은 포지션에서만
+     * solve() 로 점수를 유지하는 컬럼을 찾는다. 탐색 직후라면 대부분 테이블만 읽고 끝난다.
+     * 저장된 수는 베타 컷을 낸 수일 수도 있으므로, 수순 뒷부분에는 점수가 같은 다른 수가 섞일 수 있다.
+     * @return 컬럼 번호(0부터) 목록. 승리하는 수 또는 보드가 가득 찰 때까지 이어진다.
+     */
+    std::vector<int> principalVariation(const Position &P)
+    {
+      std::vector<int> line;
+      Position Q(P);
+      while(Q.nbMoves() < Position::WIDTH*Position::HEIGHT) {
+        int win = -1;
+        for(int col : ColumnOrder::columns)
+          if(Q.canPlay(col) && Q.isWinningMove(col)) {
+            win = col;
+            break;
+          }
+        if(win >= 0) {
+          line.push_back(win);
+          break;
+        }
+
+        bool mirrored = false;
+        bitboard_t key = symmetry ? Q.canonicalKey(mirrored) : Q.key();
+        int best = valueMove(transTable.get(key), mirrored);
+        if(best < 0 || !Q.canPlay(best)) {
+          // 테이블에 수가 없으면 직접 풀어서 점수를 유지하는 컬럼을 중앙부터 찾는다.
+          int score = solve(Q);
+          best = -1;
+          for(int col : ColumnOrder::columns) {
+            if(!Q.canPlay(col)) continue;
+            Position Q2(Q);
+            Q2.playCol(col);
+            if(-solve(Q2) == score) {
+              best = col;
+              break;
+            }
+          }
+          if(best < 0) break;
+        }
+        line.push_back(best);
+        Q.playCol(best);
+      }
+      return line;
+    }
+
+    // 진행 중인 시간 제한 탐색과 보조 스레드를 중단시킨다. 다른 스레드에서 호출한다.
+    void cancel()
+    {
+      stop.store(true);
+    }
+
+    /**
+     * 착수 가능한 모든 컬럼의 점수를 동시에 계산한다.
+     * @param shareTable : true 면 모든 컬럼이 솔버의 테이블 하나를 공유하고,
+     *                     false 면 컬럼마다 별도의 테이블을 만들어 사용한다.
+     * @return 컬럼별 점수 배열 (현재 착수할 플레이어 입장). 착수할 수 없는 컬럼은 INVALID_MOVE.
+     */
+    std::vector<int> analyze(const Position &P, bool weak = false, bool shareTable = true)
+    {
+      std::vector<int> scores(Position::WIDTH, INVALID_MOVE);
+      std::vector<std::future<SearchStats> > pending;
+      lastStats.clear();
+      if(!pool) pool.reset(new ThreadPool(Position::WIDTH));
+
+      for(int col = 0; col < Position::WIDTH; col++) {
+        if(!P.canPlay(col)) continue;
+        if(P.isWinningMove(col)) {
+          scores[col] = (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+          continue;
+        }
+        Position P2(P);
+        P2.playCol(col);
+        int *score = &scores[col];
+        pending.push_back(pool->submit([this, P2, weak, shareTable, score]() {
+          std::unique_ptr<Table> own;
+          if(!shareTable) own.reset(new Table());
+          Worker w(shareTable ? &transTable : own.get(), ColumnOrder::columns, false);
+          *score = -solveWith(P2, weak, w);
+          return w.stats;
+        }));
+      }
+
+      for(auto &f : pending) lastStats += f.get();
+      return scores;
+    }
+
+    // 테이블은 0으로 채워진 메모리 매핑으로 할당되므로 따로 비울 필요가 없다.
+    BasicSolver() : nbThreads{1}, symmetry{true}, moveHistory{false}, prefetch{true}, trackReuse{false}, stop{false} {
+      lastStats.clear();
+    }
+
+  };
+
+  // 클래스 안에서 초기화한 정적 상수의 정의. 참조로 넘겨질 때(odr-use) 필요하다.
+  template<int W, int H> const int BasicSolver<W, H>::INVALID_MOVE;
+
+  typedef BasicSolver<7, 6> Solver;
+
+}}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace GameSolver { namespace Connect4 {
+
+  // 고정된 개수의 스레드로 작업을 처리하는 단순한 스레드 풀.
+  // submit() 으로 넣은 작업의 결과는 std::future 로 받는다.
+  // 소멸자는 큐에 남은 작업을 모두 처리한 뒤 스레드를 정리한다.
+  class ThreadPool {
+    public:
+
+    explicit ThreadPool(unsigned int n): done{false}
+    {
+      if(n == 0) n = 1;
+      for(unsigned int i = 0; i < n; i++)
+        workers.push_back(std::thread([this]() { run(); }));
+    }
+
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+      }
+      cv.notify_all();
+      for(auto &w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<class F>
+    std::future<typename std::result_of<F()>::type> submit(F f)
+    {
+      typedef typename std::result_of<F()>::type R;
+      auto task = std::make_shared<std::packaged_task<R()> >(f);
+      std::future<R> result = task->get_future();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push([task]() { (*task)(); });
+      }
+      cv.notify_one();
+      return result;
+    }
+
+    unsigned int size() const
+    {
+      return workers.size();
+    }
+
+    private:
+
+    void run()
+    {
+      for(;;) {
+        std::function<void()> task;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cv.wait(lock, [this]() { return done || !tasks.empty(); });
+          if(tasks.empty()) return;
+          task = std::move(tasks.front());
+          tasks.pop();
+        }
+        task();
+      }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()> > tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done;
+  };
+
+}}
+
+#endif
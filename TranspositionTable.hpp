@@ -31,68 +31,588 @@
 #ifndef TRANSPOSITION_TABLE_HPP
 #define TRANSPOSITION_TABLE_HPP
 
-#include<vector>
+#include<atomic>
+#include<cstdint>
+#include<cstdio>
 #include<cstring>
 #include<cassert>
+#include<new>
+#include<string>
+#include<thread>
+#include<vector>
+#include<type_traits>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<sys/syscall.h>
 
 /**
- * Transposition Table is a simple hash map with fixed storage size.
- * In case of collision we keep the last entry and overide the previous one.
+ * Transposition Table is a hash map with fixed storage size.
+ *
+ * The storage is split into 64-byte buckets aligned on cache lines, each
+ * bucket holding several entries. A key can live in any entry of its bucket,
+ * so a lookup costs a single cache miss and a collision no longer destroys
+ * the previous result. When a bucket is full, the entry with the largest
+ * depth (number of moves played, i.e. the farthest from the root and the
+ * cheapest to recompute) is replaced.
+ *
+ * Only a partial key is stored. Keys are first hashed with a bijection
+ * on key_size bits (multiplication by an odd constant modulo 2^key_size),
+ * the top log2(number of buckets) bits of the hash select the bucket and
+ * the remaining low bits are stored. As the bucket index and the stored
+ * bits together are the whole hash, the full key is known without storing
+ * it (the same argument as the Chinese remainder trick with a prime size).
+ *
+ * @param key_t: unsigned type holding the stored part of the key.
+ * @param value_t: unsigned type holding the values.
+ * @param key_size: number of significant bits of the keys. Keys of more
+ * than 64 bits (boards larger than 64 cells) are passed and hashed as
+ * unsigned __int128; up to 64 bits they stay uint64_t.
+ * @param min_log_size: log2 of the default and smallest number of buckets.
+ * The stored part of the key must fit in key_t for this size; larger
+ * tables (resize()) simply leave the top bits of the stored keys unused.
+ *
+ * Entries are stored in three arrays of atomics (stored keys, values and
+ * depths), so that several search threads can share the same table without
+ * any lock. The stored key is XORed with a hash of the value: if a reader
+ * sees the key of one write and the value of another, the check fails and
+ * the entry is reported missing instead of returning a wrong value.
+ *
+ * Each entry also records the generation in which it was written, in the
+ * top bits of its depth byte. During a game the caller starts a new
+ * generation at every move (nextGeneration()). Entries of an older
+ * generation are replaced before any entry of the current one, and
+ * isPrevious() tells whether a key was stored in an older generation.
+ * prune(min_depth) clears the entries of positions with fewer moves than
+ * the current root, which can no longer be reached.
+ *
+ * The storage is an anonymous memory mapping, so a new table is already
+ * empty (zero pages) and costs no memset. resize() reallocates the table
+ * with 2^log_size buckets chosen at run time, optionally backed by huge
+ * pages (explicit hugetlbfs pages, or transparent huge pages when none are
+ * reserved) to cut the TLB misses of the random bucket accesses, and
+ * optionally interleaved over all NUMA nodes (mbind) so that threads on
+ * every socket see the same average latency. A resized table and reset()
+ * are zero-filled by several threads in parallel, which also makes the
+ * kernel fault in (and place) every page before the search starts.
  *
- * We use 56-bit keys and 8-bit non-null values
+ * A table can be saved to a file and reopened later through mmap: the
+ * snapshot starts with a 64-byte header giving the board dimensions, the
+ * table size, the entry format and a checksum of the buckets, and load()
+ * refuses a file whose header does not match (the table takes the size
+ * recorded in the file). The file is mapped privately (copy on write), so
+ * the search never modifies the snapshot on disk.
  */
+template<class key_t, class value_t, int key_size, int min_log_size>
 class TranspositionTable {
+#ifdef __SIZEOF_INT128__
+  static_assert(key_size <= 128, "keys must fit in 128 bits");
+#else
+  static_assert(key_size <= 64, "keys must fit in 64 bits");
+#endif
+  static_assert(min_log_size > 0 && min_log_size <= key_size, "invalid table size");
+  static_assert(key_size - min_log_size <= int(8*sizeof(key_t)),
+                "key_t is too small to store the part of the key not given by the bucket index");
+
+  public:
+
+  // type of the full keys given to put() and get()
+#ifdef __SIZEOF_INT128__
+  typedef typename std::conditional<(key_size > 64), unsigned __int128, uint64_t>::type full_key_t;
+#else
+  typedef uint64_t full_key_t;
+#endif
+
+  // entries per 64-byte bucket
+  static const unsigned int BUCKET_SIZE = 64 / (sizeof(key_t) + sizeof(value_t) + 1);
+
+  // the depth byte keeps the depth in its low DEPTH_BITS bits and the generation above
+  static const int DEPTH_BITS = 6;
+  static const unsigned int MAX_DEPTH = (1 << DEPTH_BITS) - 1;
+  static const unsigned int GENERATIONS = 1 << (8 - DEPTH_BITS);
+
+  // allocation flags of resize()
+  static const unsigned int SMALL_PAGES = 1;             // never use huge pages (madvise(MADV_NOHUGEPAGE))
+  static const unsigned int TRANSPARENT_HUGE_PAGES = 2;  // ask for transparent huge pages (madvise(MADV_HUGEPAGE))
+  static const unsigned int HUGETLB_PAGES = 4;           // reserved huge pages (MAP_HUGETLB), else the other flags
+  static const unsigned int INTERLEAVE = 8;              // interleave the pages over all NUMA nodes
+
+  // largest table accepted by resize(): 2^36 buckets (4TB)
+  static const int MAX_LOG_SIZE = key_size < 36 ? key_size : 36;
+
   private:
 
-  struct Entry {
-    uint64_t key: 56; // use 56-bit keys
-    uint8_t val;      // use 8-bit values
-  };                  // overall sizeof(Entry) = 8 bytes
+  // 2MB, the usual size of a huge page on x86-64
+  static const size_t HUGE_PAGE_SIZE = size_t(1) << 21;
+
+  // mask of the key_size significant bits of a key
+  static constexpr full_key_t KEY_MASK = ~full_key_t(0) >> (8*sizeof(full_key_t) - key_size);
+
+  struct alignas(64) Bucket {
+    std::atomic<key_t> K[BUCKET_SIZE];
+    std::atomic<value_t> V[BUCKET_SIZE];
+    std::atomic<uint8_t> D[BUCKET_SIZE];
+  };
+  static_assert(sizeof(Bucket) == 64, "Bucket must fill exactly one cache line");
+
+  Bucket *T;
+  void *mapping;      // start of the memory mapping holding T
+  size_t mappingSize;
+  uint8_t generation; // generation of the entries written now, in [0, GENERATIONS)
+  int logSize;        // log2 of the number of buckets
+  int storedBits;     // bits of the hash stored in the entries (key_size - logSize)
+  const char *pages;  // kind of pages backing the table, for reports
+  bool interleaved;   // whether the pages are interleaved over NUMA nodes
+
+  /*
+   * Header of a snapshot file, followed by the raw buckets.
+   */
+  struct alignas(64) SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t width, height;
+    uint32_t keySize, logSize;
+    uint32_t keyBytes, valueBytes, bucketSize;
+    uint64_t checksum;
+  };
+  static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must keep buckets aligned");
+
+  static const uint32_t SNAPSHOT_VERSION = 1;
+
+  SnapshotHeader header(uint32_t width, uint32_t height) const {
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "C4TTSNAP", 8);
+    h.version = SNAPSHOT_VERSION;
+    h.width = width;
+    h.height = height;
+    h.keySize = key_size;
+    h.logSize = logSize;
+    h.keyBytes = sizeof(key_t);
+    h.valueBytes = sizeof(value_t);
+    h.bucketSize = BUCKET_SIZE;
+    return h;
+  }
+
+  /*
+   * 64-bit checksum of the buckets (multiply-xorshift over 64-bit words).
+   */
+  static uint64_t checksum(const Bucket *buckets, uint64_t count) {
+    const uint64_t *w = reinterpret_cast<const uint64_t*>(buckets);
+    uint64_t sum = 0;
+    for(uint64_t i = 0; i < count * sizeof(Bucket) / 8; i++) {
+      sum = (sum ^ w[i]) * UINT64_C(0x100000001B3);
+      sum ^= sum >> 29;
+    }
+    return sum;
+  }
+
+  void unmap() {
+    if(mapping) munmap(mapping, mappingSize);
+    mapping = 0;
+  }
 
-  std::vector<Entry> T;
+  /*
+   * Run fill(begin, end) over [0, count) buckets, split among the hardware threads.
+   * Slices are at least 16MB, so small tables stay on the calling thread.
+   */
+  template<class F>
+  static void parallelFor(uint64_t count, F fill) {
+    uint64_t slices = count / ((UINT64_C(1) << 24) / sizeof(Bucket));
+    unsigned int n = std::thread::hardware_concurrency();
+    if(n == 0) n = 1;
+    if(slices < n) n = slices ? unsigned(slices) : 1;
+    std::vector<std::thread> threads;
+    for(unsigned int t = 1; t < n; t++)
+      threads.push_back(std::thread(fill, count * t / n, count * (t + 1) / n));
+    fill(0, count / n);
+    for(auto &t : threads) t.join();
+  }
 
-  unsigned int index(uint64_t key) const {
-    return key%T.size();
+  /*
+   * Bitmask of the online NUMA nodes, from /sys/devices/system/node/online ("0-1,3").
+   * @return number of nodes, 0 if unknown.
+   */
+  static int onlineNodes(unsigned long *mask, int bits) {
+    FILE *f = fopen("/sys/devices/system/node/online", "r");
+    if(!f) return 0;
+    int count = 0, first, last;
+    while(fscanf(f, "%d", &first) == 1) {
+      last = first;
+      int c = fgetc(f);
+      if(c == '-' && fscanf(f, "%d", &last) == 1) c = fgetc(f);
+      for(int node = first; node <= last && node < bits; node++, count++)
+        mask[node / (8*sizeof(long))] |= 1UL << (node % (8*sizeof(long)));
+      if(c != ',') break;
+    }
+    fclose(f);
+    return count;
+  }
+
+  /*
+   * Interleave the pages of [p, p+bytes) over all NUMA nodes. Must be called before the pages are touched.
+   * Uses the mbind system call directly, so no libnuma is needed.
+   * @return false on single-node machines or if the kernel refuses.
+   */
+  static bool interleave(void *p, size_t bytes) {
+#ifdef SYS_mbind
+    const int MPOL_INTERLEAVE_MODE = 3;  // MPOL_INTERLEAVE of <linux/mempolicy.h>
+    unsigned long mask[16] = {0};
+    if(onlineNodes(mask, 8*sizeof(mask)) < 2) return false;
+    return syscall(SYS_mbind, p, bytes, MPOL_INTERLEAVE_MODE, mask, 8*sizeof(mask) + 1, 0) == 0;
+#else
+    (void)p; (void)bytes;
+    return false;
+#endif
+  }
+
+  /*
+   * Map bytes of zeroed memory following flags, aligned on HUGE_PAGE_SIZE when huge pages are wanted.
+   * @return false if no memory could be mapped.
+   */
+  bool allocate(size_t bytes, unsigned int flags) {
+    void *p = MAP_FAILED;
+    size_t length = bytes;
+    size_t offset = 0;
+    pages = "default";
+#ifdef MAP_HUGETLB
+    if(flags & HUGETLB_PAGES) {
+      length = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+      p = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if(p != MAP_FAILED) pages = "hugetlb";
+    }
+#endif
+    if(p == MAP_FAILED) {
+      // transparent huge pages only back 2MB-aligned ranges, so over-allocate and align the table
+      bool thp = (flags & (TRANSPARENT_HUGE_PAGES | HUGETLB_PAGES)) != 0;
+      length = thp ? bytes + HUGE_PAGE_SIZE : bytes;
+      p = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(p == MAP_FAILED) return false;
+      if(thp) offset = (HUGE_PAGE_SIZE - uintptr_t(p) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+      if(thp && madvise(static_cast<char*>(p) + offset, bytes, MADV_HUGEPAGE) == 0) pages = "thp";
+      else if((flags & SMALL_PAGES) && madvise(p, length, MADV_NOHUGEPAGE) == 0) pages = "small";
+#endif
+    }
+    interleaved = (flags & INTERLEAVE) && interleave(p, length);
+    unmap();
+    mapping = p;
+    mappingSize = length;
+    T = reinterpret_cast<Bucket*>(static_cast<char*>(p) + offset);
+    return true;
+  }
+
+  /*
+   * Bijective hash on key_size bits: multiplication by an odd constant modulo 2^key_size.
+   * The top bits spread neighbouring keys over the whole table.
+   */
+  static full_key_t hash(full_key_t key) {
+    return (key * UINT64_C(0x9E3779B97F4A7C15)) & KEY_MASK;
+  }
+
+  uint64_t index(full_key_t h) const {
+    return uint64_t(h >> storedBits);
+  }
+
+  key_t stored(full_key_t h) const {
+    return key_t(h & ((full_key_t(1) << storedBits) - 1));
+  }
+
+  // hash of the value XORed into the stored key
+  static key_t check(value_t val) {
+    return key_t(uint64_t(val) * UINT64_C(0x9E3779B97F4A7C15));
   }
 
   public:
 
-  TranspositionTable(unsigned int size): T(size) {
-    assert(size > 0);
+  TranspositionTable(): mapping{0}, mappingSize{0}, generation{0},
+    logSize{min_log_size}, storedBits{key_size - min_log_size}, pages{"default"}, interleaved{false} {
+    if(!allocate(size() * sizeof(Bucket), 0)) throw std::bad_alloc();
+  }
+
+  ~TranspositionTable() {
+    unmap();
+  }
+
+  TranspositionTable(const TranspositionTable&) = delete;
+  TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+  /*
+   * Number of buckets.
+   */
+  uint64_t size() const {
+    return UINT64_C(1) << logSize;
+  }
+
+  int getLogSize() const {
+    return logSize;
+  }
+
+  /*
+   * Kind of pages backing the table: "hugetlb", "thp", "small" or "default" (system policy).
+   */
+  const char* getPages() const {
+    return pages;
+  }
+
+  bool isInterleaved() const {
+    return interleaved;
+  }
+
+  /**
+   * Reallocate an empty table of 2^log_size buckets.
+   * Must not be called while other threads use the table.
+   * @param flags: SMALL_PAGES, TRANSPARENT_HUGE_PAGES, HUGETLB_PAGES and INTERLEAVE.
+   * @return false if log_size is out of [min_log_size, MAX_LOG_SIZE] or the memory is not available,
+   * in which case the table is left unchanged.
+   */
+  bool resize(int log_size, unsigned int flags = 0) {
+    if(log_size < min_log_size || log_size > MAX_LOG_SIZE) return false;
+    int oldLog = logSize;
+    logSize = log_size;
+    if(!allocate(size() * sizeof(Bucket), flags)) {
+      logSize = oldLog;
+      return false;
+    }
+    storedBits = key_size - logSize;
+    reset();
+    return true;
   }
 
   /*
    * Empty the Transition Table.
+   * Large tables are cleared by several threads.
    */
   void reset() { // fill everything with 0, because 0 value means missing data
-    memset(&T[0], 0, T.size()*sizeof(Entry));
+    Bucket *buckets = T;
+    parallelFor(size(), [buckets](uint64_t begin, uint64_t end) {
+      memset(static_cast<void*>(buckets + begin), 0, (end - begin) * sizeof(Bucket));
+    });
+  }
+
+  /*
+   * Bucket of a key: keys of the same bucket compete for its BUCKET_SIZE entries.
+   * For tests and statistics.
+   */
+  uint64_t bucket(full_key_t key) const {
+    assert((key & ~KEY_MASK) == 0);
+    return index(hash(key));
+  }
+
+  /*
+   * Number of non-empty entries, for statistics.
+   */
+  uint64_t occupancy() const {
+    uint64_t n = 0;
+    for(uint64_t i = 0; i < size(); i++)
+      for(unsigned int j = 0; j < BUCKET_SIZE; j++)
+        if(T[i].V[j].load(std::memory_order_relaxed)) n++;
+    return n;
+  }
+
+  /**
+   * Save the table to a snapshot file.
+   * The table must not be modified by another thread during the save.
+   * The snapshot is written to a temporary file then renamed, so that a table
+   * loaded from the same path (still mapped from it) is never truncated under us.
+   * @param width, height: board dimensions recorded in the header.
+   * @return true on success.
+   */
+  bool save(const char *path, uint32_t width, uint32_t height) const {
+    SnapshotHeader h = header(width, height);
+    h.checksum = checksum(T, size());
+    std::string tmp = std::string(path) + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if(!f) return false;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(T, sizeof(Bucket), size(), f) == size();
+    ok = fclose(f) == 0 && ok && rename(tmp.c_str(), path) == 0;
+    if(!ok) unlink(tmp.c_str());
+    return ok;
+  }
+
+  /**
+   * Replace the content of the table by a snapshot file, mapped in memory.
+   * The file is rejected if its board dimensions, entry format or checksum do not match.
+   * @return true on success. On failure the table is left unchanged.
+   */
+  bool load(const char *path, uint32_t width, uint32_t height) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return false;
+
+    SnapshotHeader expected = header(width, height), h;
+    size_t length = 0;
+    uint64_t count = 0;
+    struct stat st;
+    void *p = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && pread(fd, &h, sizeof(h), 0) == ssize_t(sizeof(h)) &&
+       int(h.logSize) >= min_log_size && int(h.logSize) <= MAX_LOG_SIZE) {
+      expected.checksum = h.checksum;
+      expected.logSize = h.logSize;
+      count = UINT64_C(1) << h.logSize;
+      length = sizeof(SnapshotHeader) + count * sizeof(Bucket);
+      if(size_t(st.st_size) == length && memcmp(&h, &expected, sizeof(h)) == 0)
+        p = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if(p == MAP_FAILED) return false;
+
+    Bucket *buckets = reinterpret_cast<Bucket*>(static_cast<char*>(p) + sizeof(SnapshotHeader));
+    if(checksum(buckets, count) != h.checksum) {
+      munmap(p, length);
+      return false;
+    }
+    unmap();
+    mapping = p;
+    mappingSize = length;
+    T = buckets;
+    logSize = h.logSize;
+    storedBits = key_size - logSize;
+    pages = "file";
+    interleaved = false;
+    return true;
   }
 
   /**
    * Store a value for a given key
-   * @param key: 56-bit key
-   * @param value: non-null 8-bit value. null (0) value are used to encode missing data.
+   * @param key: key_size-bit key
+   * @param value: non-null value. null (0) value are used to encode missing data.
+   * @param depth: number of moves of the position (at most MAX_DEPTH), used by the replacement policy.
+   * @return true if a live entry of another key was evicted (not when an empty
+   * entry or the entry of the same key was written).
    */
-  void put(uint64_t key, uint8_t val) {
-    assert(key < (1LL << 56));
-    unsigned int i = index(key); // compute the index position
-    T[i].key = key;              // and overide any existing value.
-    T[i].val = val;
+  bool put(full_key_t key, value_t val, uint8_t depth) {
+    assert((key & ~KEY_MASK) == 0);
+    assert(val != 0);
+    assert(depth <= MAX_DEPTH);
+    full_key_t h = hash(key);
+    Bucket &b = T[index(h)];
+    key_t k = stored(h);
+
+    // reuse the entry of the same key, or else replace an entry of an older generation
+    // or the deepest one (empty entries first, then older generations, then depth).
+    unsigned int victim = 0;
+    int victimRank = -1;
+    bool evicted = true;  // cleared when an empty entry or the entry of the same key is found
+    for(unsigned int i = 0; i < BUCKET_SIZE; i++) {
+      value_t v = b.V[i].load(std::memory_order_relaxed);
+      if(v == 0 || key_t(b.K[i].load(std::memory_order_relaxed) ^ check(v)) == k) {
+        victim = i;
+        evicted = false;
+        break;
+      }
+      unsigned int d = b.D[i].load(std::memory_order_relaxed);
+      int rank = (d & MAX_DEPTH) + ((d >> DEPTH_BITS) != generation ? MAX_DEPTH + 1 : 0);
+      if(rank > victimRank) {
+        victim = i;
+        victimRank = rank;
+      }
+    }
+    b.V[victim].store(val, std::memory_order_relaxed);
+    b.K[victim].store(k ^ check(val), std::memory_order_relaxed);
+    b.D[victim].store(uint8_t(depth | generation << DEPTH_BITS), std::memory_order_relaxed);
+    return evicted;
   }
 
+  /**
+   * Start loading the bucket of a key into the cache, ahead of a get() or put()
+   * of that key. The bucket is one cache line, so a single prefetch covers it.
+   * @param key
+   */
+  void prefetch(full_key_t key) const {
+    assert((key & ~KEY_MASK) == 0);
+    __builtin_prefetch(&T[index(hash(key))]);
+  }
 
   /**
    * Get the value of a key
    * @param key
-   * @return 8-bit value associated with the key if present, 0 otherwise.
-   */
-  uint8_t get(uint64_t key) const {
-    assert(key < (1LL << 56));
-    unsigned int i = index(key);  // compute the index position
-    if(T[i].key == key)
-      return T[i].val;            // and return value if key matches
-    else
-      return 0;                   // or 0 if missing entry
+   * @return value associated with the key if present, 0 otherwise.
+   */
+  value_t get(full_key_t key) const {
+    assert((key & ~KEY_MASK) == 0);
+    full_key_t h = hash(key);
+    const Bucket &b = T[index(h)];
+    key_t k = stored(h);
+    for(unsigned int i = 0; i < BUCKET_SIZE; i++) {
+      value_t v = b.V[i].load(std::memory_order_relaxed);
+      if(v && key_t(b.K[i].load(std::memory_order_relaxed) ^ check(v)) == k)
+        return v;                 // and return value if key matches
+    }
+    return 0;                     // or 0 if missing entry
+  }
+
+  /**
+   * Whether the entry of a key was written in an older generation
+   * (before the last nextGeneration()). Used for statistics after a hit of get().
+   * @param key
+   * @return false if the key is missing or belongs to the current generation.
+   * Kept out of line so that it does not grow the search function calling it.
+   */
+  __attribute__((noinline)) bool isPrevious(full_key_t key) const {
+    assert((key & ~KEY_MASK) == 0);
+    full_key_t h = hash(key);
+    const Bucket &b = T[index(h)];
+    key_t k = stored(h);
+    for(unsigned int i = 0; i < BUCKET_SIZE; i++) {
+      value_t v = b.V[i].load(std::memory_order_relaxed);
+      if(v && key_t(b.K[i].load(std::memory_order_relaxed) ^ check(v)) == k)
+        return (b.D[i].load(std::memory_order_relaxed) >> DEPTH_BITS) != generation;
+    }
+    return false;
+  }
+
+  /*
+   * Start a new generation: entries written until now become the first candidates for replacement.
+   * Must not be called while other threads use the table.
+   */
+  void nextGeneration() {
+    generation = (generation + 1) % GENERATIONS;
+  }
+
+  /**
+   * Clear the entries whose depth is below min_depth.
+   * The remaining entries of each bucket are moved to its front: put() stops
+   * at the first empty entry, so a hole before a live entry would let the
+   * same key be stored twice.
+   * Must not be called while other threads use the table. Large tables are scanned by several threads.
+   * @return number of cleared entries.
+   */
+  uint64_t prune(unsigned int min_depth) {
+    std::atomic<uint64_t> cleared{0};
+    Bucket *buckets = T;
+    parallelFor(size(), [buckets, min_depth, &cleared](uint64_t begin, uint64_t end) {
+      uint64_t n = 0;
+      for(uint64_t i = begin; i < end; i++) {
+        Bucket &b = buckets[i];
+        unsigned int kept = 0, used = 0;
+        for(unsigned int j = 0; j < BUCKET_SIZE; j++) {
+          value_t v = b.V[j].load(std::memory_order_relaxed);
+          if(!v) continue;
+          used = j + 1;
+          uint8_t d = b.D[j].load(std::memory_order_relaxed);
+          if((d & MAX_DEPTH) < min_depth) {
+            n++;
+            continue;
+          }
+          if(kept != j) {
+            b.K[kept].store(b.K[j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            b.V[kept].store(v, std::memory_order_relaxed);
+            b.D[kept].store(d, std::memory_order_relaxed);
+          }
+          kept++;
+        }
+        // only the entries that were in use are written, so untouched pages stay untouched
+        for(unsigned int j = kept; j < used; j++) {
+          b.K[j].store(0, std::memory_order_relaxed);
+          b.V[j].store(0, std::memory_order_relaxed);
+          b.D[j].store(0, std::memory_order_relaxed);
+        }
+      }
+      cleared += n;
+    });
+    return cleared;
   }
 
 };
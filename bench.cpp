@@ -0,0 +1,553 @@
+/*
+ * This file is part of Connect4 Game Solver <http://connect4.gamesolver.org>
+ * Copyright (C) 2007 Pascal Pons <contact@gamesolver.org>
+ *
+ * Connect4 Game Solver is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Connect4 Game Solver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Connect4 Game Solver. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+// 솔버 벤치마크
+// 기본 : 표준 포지션 세트(bench/*.txt)를 풀어서 세트별로 평균, p50, p99 소요 시간과
+//   초당 노드 수, 테이블 적중률을 출력한다. 기대 점수와 다른 결과가 하나라도 있으면 1을 리턴한다.
+//   먼저 테이블 put() 의 덮어쓰기 판정(SearchStats::ttOverwrites)을 확인하고, 틀리면 1을 리턴한다.
+//   세트 파일은 한 줄에 "수순 점수" 형식이며, 테이블은 세트마다 한 번만 비운다.
+//   negamax 를 고친 뒤에는 항상 이 결과를 이전 결과와 비교해야 한다.
+//   --json 파일을 주면 세트별 탐색 통계(SearchStats)를 한 줄에 하나씩 JSON 으로 덧붙여 기록한다.
+//   --history 를 주면 킬러/히스토리 수 정렬을 켜고 푼다. 옵션 없이 돌린 결과와 비교해 효과를 확인한다.
+// --compare : 멀티스레드/analyze/대칭 비교
+// 1. Lazy SMP : 같은 포지션들을 단일 스레드와 N 스레드로 각각 풀어서 소요 시간과 속도 향상 비율을 출력한다.
+//    단일 스레드 탐색의 노드 수와 테이블 적중률도 함께 출력한다.
+// 2. analyze : 모든 자식 컬럼을 순서대로 solve() 할 때와 analyze() 로 동시에 풀 때의 시간을 비교한다.
+// 3. 대칭 : 좌우 대칭 키를 쓰지 않을 때와 쓸 때의 노드 수, 테이블 사용 엔트리 수, 시간을 비교한다.
+// --bulk : BulkEval 의 경로(scalar/avx2/avx512)별 단일 코어 처리량을 비교한다.
+//   무작위 포지션에 대해 승리 칸, 지지 않는 수, 수 점수를 계산하고, 모든 경로의 결과가 Position 과 같은지 확인한다.
+// --table : 테이블 크기(64MB ~ 1GB)와 페이지 종류(small/thp/hugetlb)별로 테이블 할당과 비우기에 걸린 시간,
+//   세트 파일 하나(기본 middle_medium)를 푸는 초당 노드 수와 노드당 캐시 미스, dTLB 읽기 미스 수를 출력한다.
+//   미스 수는 perf_event_open 으로 읽으며, 권한이 없으면 "-" 로 표시한다. (kernel.perf_event_paranoid)
+// --no-prefetch : 자식 포지션의 테이블 버킷을 미리 불러오지 않고 푼다. 기본 모드나 --table 과 함께 써서 효과를 비교한다.
+// 사용법 : ./C4Bench [-t 스레드수] [--history] [--no-prefetch] [--json 파일] [세트파일 ...]   (기본값은 단일 스레드, bench/ 의 표준 세트 4개)
+//          ./C4Bench --compare [-t 스레드수]       (기본값은 하드웨어 스레드 수)
+//          ./C4Bench --bulk
+//          ./C4Bench --table [-t 스레드수] [--no-prefetch] [세트파일]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include "position.hpp"
+#include "Solver.hpp"
+#include "BulkEval.hpp"
+
+using namespace GameSolver::Connect4;
+
+// 표준 세트. 위에서부터 빈 칸이 많아지고 풀기 어려워진다.
+static const char* STANDARD_SETS[] = {
+  "bench/end_easy.txt",       // 28 ~ 41수 둔 종반 포지션
+  "bench/middle_easy.txt",    // 14 ~ 27수, 2만 노드 미만
+  "bench/middle_medium.txt",  // 14 ~ 27수, 2만 ~ 100만 노드
+  "bench/begin_hard.txt",     // 6 ~ 13수, 100만 ~ 2000만 노드
+};
+
+// 단일 스레드 기준 0.1 ~ 2초 정도 걸리는 중반 포지션들
+static const char* POSITIONS[] = {
+  "6772257244",
+  "3444431442",
+  "1451717143",
+  "64451735",
+  "33566352",
+  "53251677",
+  "4444441177",  // 좌우 대칭 포지션
+};
+
+// analyze 비교용 포지션. 자식 컬럼 7개를 모두 풀어야 한다.
+static const char* ANALYZE_POSITIONS[] = {
+  "677225724",
+  "344443144",
+  "145171714",
+  "3356635",
+};
+
+// 테이블을 비운 상태에서 포지션 하나를 풀고 걸린 시간(초)을 리턴한다.
+static double timeSolve(Solver &solver, const Position &P, int &score)
+{
+  solver.reset();
+  auto start = std::chrono::steady_clock::now();
+  score = solver.solve(P);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 정렬된 값들의 p 분위수 (nearest-rank)
+static double percentile(const std::vector<double> &sorted, double p)
+{
+  size_t rank = size_t(std::ceil(p * sorted.size()));
+  return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+// 세트 파일 하나를 풀고 결과 한 줄을 출력한다. 점수가 틀린 포지션 수를 리턴한다. 파일 오류는 -1.
+static int runSet(Solver &solver, const char *path, std::ostream *json)
+{
+  std::ifstream in(path);
+  if(!in) {
+    std::cerr << "세트 파일을 열 수 없습니다 : " << path << '\n';
+    return -1;
+  }
+
+  std::vector<double> micros;
+  SearchStats stats;
+  stats.clear();
+  double total = 0;
+  int wrong = 0;
+  std::string line;
+  unsigned int lineNo = 0;
+
+  solver.reset();
+  while(std::getline(in, line)) {
+    lineNo++;
+    std::istringstream ls(line);
+    std::string seq;
+    int expected;
+    if(!(ls >> seq)) continue;  // 빈 줄
+    Position P;
+    if(!(ls >> expected) || P.play(seq) != seq.size()) {
+      std::cerr << path << ':' << lineNo << " 잘못된 줄 : " << line << '\n';
+      return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int score = solver.solve(P);
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    micros.push_back(t * 1e6);
+    total += t;
+    stats += solver.getStats();
+    if(score != expected) {
+      std::cerr << path << ':' << lineNo << ' ' << seq << " 점수 불일치 : " << score << " (기대값 " << expected << ")\n";
+      wrong++;
+    }
+  }
+  if(micros.empty()) {
+    std::cerr << "빈 세트 파일 : " << path << '\n';
+    return -1;
+  }
+
+  std::vector<double> sorted(micros);
+  std::sort(sorted.begin(), sorted.end());
+  std::string name(path);
+  size_t slash = name.find_last_of('/');
+  if(slash != std::string::npos) name = name.substr(slash + 1);
+
+  double mean = total * 1e6 / micros.size(), p50 = percentile(sorted, 0.50), p99 = percentile(sorted, 0.99);
+  double nps = total > 0 ? stats.nodes / total : 0;
+
+  std::cout << std::left << std::setw(20) << name << std::right << std::setw(7) << micros.size()
+            << std::setprecision(1) << std::setw(12) << mean << std::setw(12) << p50 << std::setw(12) << p99
+            << std::setw(12) << nps / 1000 << std::setw(9) << 100.0 * stats.hitRate()
+            << std::setw(10) << 100.0 * stats.firstMoveCutoffRate() << std::setw(7) << wrong << std::endl;
+
+  if(json) {
+    *json << std::setprecision(3) << "{\"set\":\"" << name << "\",\"count\":" << micros.size()
+          << ",\"threads\":" << solver.getThreads() << ",\"moveHistory\":" << (solver.getMoveHistory() ? "true" : "false") << ",\"meanMicros\":" << mean
+          << ",\"p50Micros\":" << p50 << ",\"p99Micros\":" << p99 << ",\"nodesPerSecond\":" << nps
+          << ",\"wrong\":" << wrong << ",\"stats\":";
+    stats.writeJson(*json);
+    *json << "}\n";
+  }
+  return wrong;
+}
+
+static int runSets(Solver &solver, const std::vector<const char*> &paths, const char *jsonPath)
+{
+  std::ofstream json;
+  if(jsonPath) {
+    json.open(jsonPath, std::ios::app);
+    if(!json) {
+      std::cerr << "JSON 파일을 열 수 없습니다 : " << jsonPath << '\n';
+      return 1;
+    }
+    json << std::fixed;
+  }
+
+  bool ok = true;
+  std::cout << std::fixed;
+  std::cout << "set                   count    mean(us)     p50(us)     p99(us)    Knodes/s   hit(%)   cut1(%)  wrong\n";
+  for(const char *path : paths)
+    if(runSet(solver, path, jsonPath ? &json : 0) != 0) ok = false;
+  return ok ? 0 : 1;
+}
+
+// 멀티스레드, analyze, 대칭 키 비교
+static int compare(Solver &solver, unsigned int threads)
+{
+  double total1 = 0, totalN = 0;
+  bool ok = true;
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "position         score        nodes   hit(%)   1-thread(s)   " << threads << "-thread(s)   speedup\n";
+  for(const char* seq : POSITIONS) {
+    Position P;
+    if(P.play(seq) != strlen(seq)) {
+      std::cerr << "잘못된 포지션 : " << seq << '\n';
+      return 1;
+    }
+
+    int score1, scoreN;
+    solver.setThreads(1);
+    double t1 = timeSolve(solver, P, score1);
+    unsigned long long nodes = solver.getNodeCount();
+    double hitRate = nodes ? 100.0 * solver.getHitCount() / nodes : 0;
+    solver.setThreads(threads);
+    double tN = timeSolve(solver, P, scoreN);
+    total1 += t1;
+    totalN += tN;
+    if(score1 != scoreN) ok = false;
+
+    std::cout << std::left << std::setw(16) << seq << std::right << std::setw(6) << score1
+              << std::setw(13) << nodes << std::setw(9) << std::setprecision(1) << hitRate << std::setprecision(3)
+              << std::setw(14) << t1 << std::setw(14) << tN << std::setw(10) << t1/tN
+              << (score1 != scoreN ? "  점수 불일치!" : "") << '\n';
+  }
+  std::cout << "total                                         " << std::setw(14) << total1 << std::setw(14) << totalN
+            << std::setw(10) << total1/totalN << '\n';
+
+  std::cout << "\nposition       sequential(s)   analyze(s)   analyze-separate-tables(s)\n";
+  solver.setThreads(1);
+  for(const char* seq : ANALYZE_POSITIONS) {
+    Position P;
+    P.play(seq);
+
+    // 기존 bySearch() 방식 : 자식 컬럼을 하나씩 순서대로 푼다.
+    std::vector<int> expected(Position::WIDTH, Solver::INVALID_MOVE);
+    solver.reset();
+    auto start = std::chrono::steady_clock::now();
+    for(int col = 0; col < Position::WIDTH; col++) {
+      if(!P.canPlay(col)) continue;
+      if(P.isWinningMove(col)) expected[col] = (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+      else {
+        Position P2(P);
+        P2.playCol(col);
+        expected[col] = -solver.solve(P2);
+      }
+    }
+    double tSeq = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double tShared, tSeparate;
+    for(int shared = 1; shared >= 0; shared--) {
+      solver.reset();
+      start = std::chrono::steady_clock::now();
+      std::vector<int> scores = solver.analyze(P, false, shared);
+      double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      (shared ? tShared : tSeparate) = t;
+      if(scores != expected) {
+        std::cout << seq << "  점수 불일치!\n";
+        ok = false;
+      }
+    }
+    std::cout << std::left << std::setw(16) << seq << std::right << std::setw(12) << tSeq
+              << std::setw(13) << tShared << std::setw(29) << tSeparate << '\n';
+  }
+
+  std::cout << "\nposition        symmetry        nodes   table-entries    time(s)\n";
+  for(const char* seq : POSITIONS) {
+    Position P;
+    P.play(seq);
+    int scores[2];
+    for(int on = 0; on < 2; on++) {
+      solver.setSymmetry(on);
+      double t = timeSolve(solver, P, scores[on]);
+      std::cout << std::left << std::setw(16) << (on ? "" : seq) << std::setw(8) << (on ? "on" : "off") << std::right
+                << std::setw(13) << solver.getNodeCount() << std::setw(16) << solver.getTableOccupancy()
+                << std::setw(11) << t << '\n';
+    }
+    if(scores[0] != scores[1]) {
+      std::cout << seq << "  점수 불일치!\n";
+      ok = false;
+    }
+  }
+  solver.setSymmetry(true);
+  return ok ? 0 : 1;
+}
+
+// BulkEval 처리량 측정. 포지션 배열은 L2 캐시에 들어가는 크기로 잡아 메모리가 아닌 연산 속도를 잰다.
+static int bulk()
+{
+  const size_t N = 1 << 14;
+  const double SECONDS = 0.2;  // 경로/함수마다 대략 이 시간 동안 반복한다.
+
+  // 무작위 수순으로 만든 포지션. 바로 이길 수 있는 포지션은 nonLosingMoves 의 전제 조건에 맞지 않으므로 뺀다.
+  // winningPositions 는 상대방 돌(opponent)로 계산해 Position::opponent_winning_position() 과 비교한다.
+  std::vector<uint64_t> position, opponent, mask, move;
+  std::vector<uint64_t> expectedWin, expectedNonLosing;
+  std::vector<int> expectedScore;
+  srand(1);
+  while(position.size() < N) {
+    Position P;
+    int depth = rand() % 36;
+    for(int i = 0; i < depth; i++) {
+      int col = rand() % Position::WIDTH;
+      if(P.canPlay(col) && !P.isWinningMove(col)) P.playCol(col);
+    }
+    if(P.canWinNext()) continue;
+    uint64_t moves = P.possible();
+    if(!moves) continue;
+    uint64_t m = moves & Position::column_mask(rand() % Position::WIDTH);
+    if(!m) m = moves & -moves;
+    position.push_back(P.positionBits());
+    opponent.push_back(P.positionBits() ^ P.maskBits());
+    mask.push_back(P.maskBits());
+    move.push_back(m);
+    expectedWin.push_back(P.opponent_winning_position());
+    expectedNonLosing.push_back(P.possibleNonLosingMoves());
+    expectedScore.push_back(P.moveScore(m));
+  }
+
+  std::vector<uint64_t> out(N);
+  std::vector<int> scores(N);
+  BulkEval::Isa best = BulkEval::detect();
+  bool ok = true;
+  double base[3] = {0, 0, 0};
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "function            isa        Mpos/s   speedup\n";
+  for(int f = 0; f < 3; f++) {
+    const char *name = f == 0 ? "winningPositions" : f == 1 ? "nonLosingMoves" : "moveScores";
+    for(int i = BulkEval::SCALAR; i <= best; i++) {
+      BulkEval::setIsa(BulkEval::Isa(i));
+      auto run = [&]() {
+        if(f == 0) BulkEval::winningPositions(opponent.data(), mask.data(), out.data(), N);
+        else if(f == 1) BulkEval::nonLosingMoves(position.data(), mask.data(), out.data(), N);
+        else BulkEval::moveScores(position.data(), mask.data(), move.data(), scores.data(), N);
+      };
+
+      run();
+      bool same = f == 0 ? out == expectedWin : f == 1 ? out == expectedNonLosing : scores == expectedScore;
+      if(!same) ok = false;
+
+      unsigned long long reps = 0;
+      auto start = std::chrono::steady_clock::now();
+      double t;
+      do {
+        for(int r = 0; r < 16; r++) run();
+        reps += 16;
+        t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      } while(t < SECONDS);
+      double rate = reps * N / t / 1e6;
+      if(i == BulkEval::SCALAR) base[f] = rate;
+      std::cout << std::left << std::setw(20) << name << std::setw(8) << BulkEval::isaName(BulkEval::Isa(i)) << std::right
+                << std::setw(10) << rate << std::setw(10) << rate / base[f] << (same ? "" : "  결과 불일치!") << '\n';
+    }
+  }
+  BulkEval::setIsa(best);
+  return ok ? 0 : 1;
+}
+
+// 테이블의 put() 이 다른 포지션의 엔트리를 밀어냈을 때만 true(ttOverwrites)를 리턴하는지 확인한다.
+// 같은 버킷에 들어가는 키들로 빈 엔트리, 같은 키의 엔트리, 가득 찬 버킷에 저장해 본다. 틀리면 false.
+static bool checkOverwrites()
+{
+  Solver::Table table;
+  const unsigned int n = Solver::Table::BUCKET_SIZE;
+  std::vector<uint64_t> keys;
+  uint64_t target = table.bucket(1);
+  for(uint64_t key = 1; keys.size() < n + 1; key++)
+    if(table.bucket(key) == target) keys.push_back(key);
+
+  bool ok = true;
+  for(unsigned int i = 0; i < n; i++) {
+    if(table.put(keys[i], 1, 10)) ok = false;       // 빈 엔트리
+    if(table.put(keys[i], 2, 10)) ok = false;       // 같은 키
+  }
+  if(!table.put(keys[n], 1, 10)) ok = false;        // 가득 찬 버킷
+  if(!ok) std::cerr << "테이블 put() 의 덮어쓰기 판정이 틀렸습니다.\n";
+  return ok;
+}
+
+// perf_event_open 으로 연 하드웨어 카운터. 이 프로세스(와 이후에 만드는 스레드)의 사용자 모드 이벤트만 센다.
+// 열 수 없으면(권한, PMU 가 없는 가상 머신) stop() 이 -1 을 리턴한다.
+class Counter {
+  public:
+
+  Counter(uint32_t type, uint64_t config)
+  {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  ~Counter()
+  {
+    if(fd >= 0) close(fd);
+  }
+
+  void start()
+  {
+    if(fd < 0) return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+
+  long long stop()
+  {
+    long long count = -1;
+    if(fd < 0) return count;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if(read(fd, &count, sizeof(count)) != sizeof(count)) count = -1;
+    return count;
+  }
+
+  private:
+  int fd;
+};
+
+// 노드당 카운터 값. 카운터를 읽을 수 없으면 "-".
+static void printPerNode(long long count, unsigned long long nodes)
+{
+  if(count >= 0 && nodes) std::cout << std::setprecision(3) << std::setw(17) << double(count) / nodes;
+  else std::cout << std::setw(17) << "-";
+}
+
+// 테이블 크기와 페이지 종류 비교
+static int table(Solver &solver, const char *path)
+{
+  std::ifstream in(path);
+  std::vector<std::pair<Position, int> > positions;
+  std::string seq;
+  int expected;
+  while(in >> seq >> expected) {
+    Position P;
+    if(P.play(seq) != seq.size()) {
+      std::cerr << path << " 잘못된 포지션 : " << seq << '\n';
+      return 1;
+    }
+    positions.push_back(std::make_pair(P, expected));
+  }
+  if(positions.empty()) {
+    std::cerr << "세트 파일을 열 수 없습니다 : " << path << '\n';
+    return 1;
+  }
+
+  static const struct { const char *name; unsigned int flags; } PAGES[] = {
+    {"small", Solver::Table::SMALL_PAGES},
+    {"thp", Solver::Table::TRANSPARENT_HUGE_PAGES},
+    {"hugetlb", Solver::Table::HUGETLB_PAGES},
+  };
+  Counter cacheMisses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  Counter tlbMisses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  bool ok = true;
+
+  std::cout << std::fixed;
+  std::cout << "size(MB)  request  pages      alloc(ms)    time(s)   Knodes/s   hit(%)  cache-miss/node   dTLB-miss/node\n";
+  for(int log = Solver::TABLE_LOG_SIZE; log <= Solver::TABLE_LOG_SIZE + 4; log += 2) {
+    for(auto &pages : PAGES) {
+      unsigned long long mb = 64ULL << (log - Solver::TABLE_LOG_SIZE);
+      auto start = std::chrono::steady_clock::now();
+      bool allocated = solver.setTableSize(log, pages.flags);
+      double alloc = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      std::cout << std::setw(8) << mb << "  " << std::left << std::setw(9) << pages.name << std::setw(9) << solver.getTablePages()
+                << std::right << std::setprecision(1) << std::setw(11) << alloc;
+      if(!allocated) {
+        std::cout << "  할당 실패\n";
+        continue;
+      }
+
+      SearchStats stats;
+      stats.clear();
+      cacheMisses.start();
+      tlbMisses.start();
+      start = std::chrono::steady_clock::now();
+      for(auto &p : positions) {
+        if(solver.solve(p.first) != p.second) ok = false;
+        stats += solver.getStats();
+      }
+      double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      long long misses = cacheMisses.stop(), tlb = tlbMisses.stop();
+
+      std::cout << std::setprecision(3) << std::setw(11) << t << std::setprecision(1) << std::setw(11) << stats.nodes / t / 1000
+                << std::setw(9) << 100.0 * stats.hitRate();
+      printPerNode(misses, stats.nodes);
+      printPerNode(tlb, stats.nodes);
+      std::cout << '\n';
+    }
+  }
+  solver.setTableSize(Solver::TABLE_LOG_SIZE);
+  if(!ok) std::cout << "점수 불일치!\n";
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int threads = 0;
+  bool compareMode = false;
+  bool bulkMode = false;
+  bool tableMode = false;
+  const char *jsonPath = 0;
+  Solver solver;
+  std::vector<const char*> sets;
+  for(int i = 1; i < argc; i++) {
+    if((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && i+1 < argc) threads = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--compare")) compareMode = true;
+    else if(!strcmp(argv[i], "--bulk")) bulkMode = true;
+    else if(!strcmp(argv[i], "--table")) tableMode = true;
+    else if(!strcmp(argv[i], "--json") && i+1 < argc) jsonPath = argv[++i];
+    else if(!strcmp(argv[i], "--history")) solver.setMoveHistory(true);
+    else if(!strcmp(argv[i], "--no-prefetch")) solver.setPrefetch(false);
+    else if(argv[i][0] != '-') sets.push_back(argv[i]);
+    else {
+      std::cerr << "사용법 : " << argv[0] << " [-t 스레드수] [--history] [--no-prefetch] [--json 파일] [세트파일 ...]\n"
+                << "         " << argv[0] << " --compare [-t 스레드수]\n"
+                << "         " << argv[0] << " --bulk\n"
+                << "         " << argv[0] << " --table [-t 스레드수] [--no-prefetch] [세트파일]\n";
+      return 1;
+    }
+  }
+
+  if(bulkMode) return bulk();
+  if(compareMode) {
+    if(threads < 1) threads = std::thread::hardware_concurrency();
+    return compare(solver, threads < 1 ? 1 : threads);
+  }
+
+  solver.setThreads(threads < 1 ? 1 : threads);
+  if(tableMode) return table(solver, sets.empty() ? "bench/middle_medium.txt" : sets[0]);
+  if(sets.empty()) sets.assign(STANDARD_SETS, STANDARD_SETS + sizeof(STANDARD_SETS)/sizeof(STANDARD_SETS[0]));
+  if(!checkOverwrites()) return 1;
+  return runSets(solver, sets, jsonPath);
+}
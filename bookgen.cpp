@@ -0,0 +1,117 @@
+/*
+ * This file is part of Connect4 Game Solver <http://connect4.gamesolver.org>
+ * Copyright (C) 2007 Pascal Pons <contact@gamesolver.org>
+ *
+ * Connect4 Game Solver is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Connect4 Game Solver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Connect4 Game Solver. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+// 오프닝 북 생성기
+// 초반 depth 수까지 나올 수 있는 모든 포지션(좌우 대칭 제외)을 Solver 로 풀어 북 파일로 저장한다.
+// 생성된 북은 C4Master --book 파일 로 사용한다.
+//
+// 사용법 : ./C4BookGen depth 파일 [-t 스레드수] [--root 착수순서]
+//   --root 를 주면 해당 포지션 아래의 포지션들만 생성한다. (특정 오프닝만 깊게 만들 때 사용)
+
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "position.hpp"
+#include "Solver.hpp"
+#include "OpeningBook.hpp"
+
+using namespace GameSolver::Connect4;
+
+// P 에서 depth 수까지 도달할 수 있는 포지션을 모은다. 게임이 이미 끝난 포지션은 제외한다.
+static void collect(const Position &P, int depth, std::unordered_set<uint64_t> &seen,
+                    std::vector<std::vector<Position> > &byDepth)
+{
+  if(!seen.insert(P.canonicalKey()).second) return;
+  byDepth[P.nbMoves()].push_back(P);
+  if(P.nbMoves() >= depth) return;
+  for(int col = 0; col < Position::WIDTH; col++) {
+    if(!P.canPlay(col) || P.isWinningMove(col)) continue;
+    Position P2(P);
+    P2.playCol(col);
+    collect(P2, depth, seen, byDepth);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 3) {
+    std::cerr << "사용법 : " << argv[0] << " depth 파일 [-t 스레드수] [--root 착수순서]\n";
+    return 1;
+  }
+  int depth = atoi(argv[1]);
+  const char *path = argv[2];
+  Solver solver;
+  Position root;
+  for(int i = 3; i < argc; i++) {
+    if((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && i+1 < argc) solver.setThreads(atoi(argv[++i]));
+    else if(!strcmp(argv[i], "--root") && i+1 < argc) {
+      std::string seq = argv[++i];
+      if(root.play(seq) != seq.size()) {
+        std::cerr << "잘못된 착수순서 : " << seq << '\n';
+        return 1;
+      }
+    } else {
+      std::cerr << "알 수 없는 인자 : " << argv[i] << '\n';
+      return 1;
+    }
+  }
+  if(depth < int(root.nbMoves()) || depth >= Position::WIDTH*Position::HEIGHT) {
+    std::cerr << "depth 는 " << root.nbMoves() << " 이상 " << Position::WIDTH*Position::HEIGHT << " 미만이어야 합니다.\n";
+    return 1;
+  }
+
+  std::unordered_set<uint64_t> seen;
+  std::vector<std::vector<Position> > byDepth(depth + 1);
+  collect(root, depth, seen, byDepth);
+  std::cerr << seen.size() << " 개의 포지션을 풉니다.\n";
+
+  // 깊은 포지션부터 풀어야 테이블에 남은 결과를 얕은 포지션 탐색에서 다시 사용할 수 있다.
+  std::vector<std::pair<uint64_t, int> > solved;
+  auto start = std::chrono::steady_clock::now();
+  for(int d = depth; d >= 0; d--) {
+    for(const Position &P : byDepth[d]) {
+      solved.push_back(std::make_pair(P.canonicalKey(), solver.solve(P)));
+      if(solved.size() % 1000 == 0) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << solved.size() << " / " << seen.size() << " (" << elapsed << "s)\n";
+      }
+    }
+  }
+
+  if(!OpeningBook::write(path, depth, solved)) {
+    std::cerr << path << " 에 저장하지 못했습니다.\n";
+    return 1;
+  }
+  std::cerr << path << " 에 " << solved.size() << " 개의 포지션을 저장했습니다.\n";
+  return 0;
+}
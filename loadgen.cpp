@@ -0,0 +1,279 @@
+/*
+ * [2018 인공지능 : 선배들을 이겨라!]
+ *   Destroy AI - 채희재, 이태훈, 문선미
+ *   >> Connect4 Game Solver 메인 로직 커스터마이징, 게임 구현 및 스타일링, 6번 수 이후 룰 - 채희재
+ *   >> 5번 수까지의 룰, 테스팅, QA - 이태훈, 문선미
+ * 본 코드는 위 주석에서 언급되었듯이
+ *   공개코드인 Connect4 Game Solver <http://connect4.gamesolver.org> 를 기반으로 합니다.
+ * 본 저작권자의 요구에 따라 GNU Affero GPL 을 따라 <https://github.com/poongnewga/Connect4>에 코드가 모두 공개되어 있습니다.
+ * 따라서 본 코드 또한 GNU Affero GPL을 따릅니다.
+ * 자세한 내용은 GNU Affero General Public License <http://www.gnu.org/licenses/> 참조.
+ */
+
+// 서버 모드(C4Master --server) 부하 측정기
+// 연결 c 개를 열고 연결마다 세션 s 개를 만든 뒤, 각 연결이 요청을 하나씩 보내고 응답을 기다리기를 반복한다.
+// 세션마다 포지션 세트의 한 포지션에서 게임을 시작해 "best" (또는 --analyze 면 "analyze") 로 최선의 수를 구하고
+// 그 수를 "play" 로 두는 것을 게임이 끝날 때까지 반복하며, 끝나면 "close" 후 다음 포지션으로 새 세션을 연다.
+// 요청 종류별로 개수, 초당 요청 수, p50/p99/p999/최대 응답 시간을 출력한다.
+// 사용법 : ./C4Load 주소 [-c 연결수] [-s 연결당세션수] [-n 연결당요청수] [--set 세트파일] [--analyze] [--millis 밀리초]
+//   주소 : 숫자면 127.0.0.1 TCP 포트, 아니면 유닉스 소켓 경로 (C4Master --server 와 같은 형식)
+//   기본값 : -c 8 -s 128 -n 2000 --set bench/end_easy.txt
+//   --millis 를 주면 best 요청을 시간 제한 탐색으로 보낸다.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+typedef std::chrono::steady_clock Clock;
+
+// 요청 종류
+enum { NEW, PLAY, SEARCH, CLOSE, KINDS };
+static const char *KIND_NAMES[KINDS] = {"new", "play", "best", "close"};
+
+// 연결 하나의 측정 결과
+struct Result {
+  std::vector<double> micros[KINDS];
+  unsigned long long errors;
+  std::string failure;     // 연결 자체가 실패한 경우의 이유
+};
+
+// 요청 한 줄을 보내고 응답 한 줄을 받는 블로킹 클라이언트
+class Client {
+  public:
+
+  Client(): fd{-1} {}
+
+  ~Client()
+  {
+    if(fd >= 0) close(fd);
+  }
+
+  bool connect(const std::string &address)
+  {
+    bool tcp = address.find_first_not_of("0123456789") == std::string::npos;
+    if(tcp) {
+      sockaddr_in a;
+      memset(&a, 0, sizeof(a));
+      a.sin_family = AF_INET;
+      a.sin_port = htons(atoi(address.c_str()));
+      a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      fd = socket(AF_INET, SOCK_STREAM, 0);
+      int one = 1;
+      if(fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      return fd >= 0 && ::connect(fd, (sockaddr*)&a, sizeof(a)) == 0;
+    }
+    sockaddr_un a;
+    memset(&a, 0, sizeof(a));
+    a.sun_family = AF_UNIX;
+    strncpy(a.sun_path, address.c_str(), sizeof(a.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    return fd >= 0 && ::connect(fd, (sockaddr*)&a, sizeof(a)) == 0;
+  }
+
+  // 실패하면 빈 문자열을 리턴한다.
+  std::string request(const std::string &line)
+  {
+    std::string out = line + '\n';
+    for(size_t sent = 0; sent < out.size();) {
+      ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+      if(n <= 0) return "";
+      sent += n;
+    }
+    size_t end;
+    while((end = buffer.find('\n')) == std::string::npos) {
+      char buf[4096];
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if(n <= 0) return "";
+      buffer.append(buf, n);
+    }
+    std::string response = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return response;
+  }
+
+  private:
+  int fd;
+  std::string buffer;
+};
+
+// 세트 파일에서 포지션(수순)만 읽는다.
+static std::vector<std::string> readSet(const std::string &path)
+{
+  std::vector<std::string> seqs;
+  std::ifstream in(path.c_str());
+  std::string line;
+  while(std::getline(in, line)) {
+    std::istringstream words(line);
+    std::string seq;
+    if(words >> seq) seqs.push_back(seq);
+  }
+  return seqs;
+}
+
+struct Options {
+  std::string address;
+  int connections = 8;
+  int sessions = 128;
+  int requests = 2000;
+  std::string set = "bench/end_easy.txt";
+  bool analyze = false;
+  int millis = 0;
+};
+
+// 연결 하나의 부하. 세션을 번갈아 가며 요청을 보낸다.
+static void runConnection(const Options &opt, const std::vector<std::string> &seqs, unsigned int seed, Result &r)
+{
+  r.errors = 0;
+  Client client;
+  if(!client.connect(opt.address)) {
+    r.failure = "connect failed";
+    return;
+  }
+
+  struct Game {
+    std::string id;
+    bool needMove;   // true 면 다음 요청은 탐색, false 면 착수
+    int col;
+  };
+  std::vector<Game> games(opt.sessions);
+  size_t next = seed % seqs.size();
+
+  auto timed = [&](int kind, const std::string &line) {
+    auto start = Clock::now();
+    std::string response = client.request(line);
+    r.micros[kind].push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    if(response.compare(0, 2, "ok") != 0) r.errors++;
+    return response;
+  };
+  auto open = [&](Game &g) {
+    std::string response = timed(NEW, "new " + seqs[next]);
+    next = (next + 1) % seqs.size();
+    g.id = response.size() > 3 ? response.substr(3) : "0";
+    g.needMove = true;
+  };
+
+  for(auto &g : games) open(g);
+  for(int i = 0; i < opt.requests; i++) {
+    Game &g = games[i % games.size()];
+    if(g.needMove) {
+      std::string line = (opt.analyze ? "analyze " : "best ") + g.id;
+      if(!opt.analyze && opt.millis > 0) line += ' ' + std::to_string(opt.millis);
+      std::istringstream response(timed(SEARCH, line));
+      std::string ok;
+      response >> ok;
+      if(ok != "ok") {
+        timed(CLOSE, "close " + g.id);
+        open(g);
+        continue;
+      }
+      if(opt.analyze) {
+        // 점수가 가장 높은 컬럼
+        int best = -1000;
+        std::string score;
+        for(int col = 1; response >> score; col++)
+          if(score != "-" && atoi(score.c_str()) > best) {
+            best = atoi(score.c_str());
+            g.col = col;
+          }
+      } else {
+        response >> g.col;
+      }
+      g.needMove = false;
+    } else {
+      std::string response = timed(PLAY, "play " + g.id + ' ' + std::to_string(g.col));
+      g.needMove = true;
+      // 게임이 끝났거나 착수에 실패하면 세션을 닫고 다음 포지션으로 새 게임을 시작한다.
+      if(response.compare(0, 2, "ok") != 0 || response.find(' ', 3) != std::string::npos) {
+        timed(CLOSE, "close " + g.id);
+        open(g);
+      }
+    }
+  }
+  for(auto &g : games) timed(CLOSE, "close " + g.id);
+  client.request("quit");
+}
+
+static double percentile(std::vector<double> &v, double p)
+{
+  if(v.empty()) return 0;
+  size_t k = size_t(std::ceil(p * v.size()));
+  if(k > 0) k--;
+  std::nth_element(v.begin(), v.begin() + k, v.end());
+  return v[k];
+}
+
+int main(int argc, char **argv)
+{
+  Options opt;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-c") && i+1 < argc) opt.connections = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-s") && i+1 < argc) opt.sessions = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-n") && i+1 < argc) opt.requests = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--set") && i+1 < argc) opt.set = argv[++i];
+    else if(!strcmp(argv[i], "--millis") && i+1 < argc) opt.millis = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--analyze")) opt.analyze = true;
+    else if(argv[i][0] != '-' && opt.address.empty()) opt.address = argv[i];
+    else opt.address.clear(), i = argc;
+  }
+  if(opt.address.empty() || opt.connections < 1 || opt.sessions < 1 || opt.requests < 0) {
+    std::cerr << "사용법 : " << argv[0] << " 주소 [-c 연결수] [-s 연결당세션수] [-n 연결당요청수] [--set 세트파일] [--analyze] [--millis 밀리초]\n";
+    return 1;
+  }
+  std::vector<std::string> seqs = readSet(opt.set);
+  if(seqs.empty()) {
+    std::cerr << opt.set << " 을 읽을 수 없습니다.\n";
+    return 1;
+  }
+  if(opt.analyze) KIND_NAMES[SEARCH] = "analyze";
+
+  std::vector<Result> results(opt.connections);
+  std::vector<std::thread> threads;
+  auto start = Clock::now();
+  for(int c = 0; c < opt.connections; c++)
+    threads.push_back(std::thread(runConnection, std::cref(opt), std::cref(seqs), unsigned(c * 7919), std::ref(results[c])));
+  for(auto &t : threads) t.join();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> all[KINDS + 1];
+  unsigned long long errors = 0;
+  for(auto &r : results) {
+    if(!r.failure.empty()) {
+      std::cerr << r.failure << '\n';
+      return 1;
+    }
+    errors += r.errors;
+    for(int k = 0; k < KINDS; k++) {
+      all[k].insert(all[k].end(), r.micros[k].begin(), r.micros[k].end());
+      all[KINDS].insert(all[KINDS].end(), r.micros[k].begin(), r.micros[k].end());
+    }
+  }
+
+  std::cout << opt.connections << " connections x " << opt.sessions << " sessions, "
+            << std::fixed << std::setprecision(2) << seconds << " s, errors " << errors << "\n\n";
+  std::cout << std::left << std::setw(10) << "request" << std::right << std::setw(10) << "count" << std::setw(12) << "req/s"
+            << std::setw(12) << "p50(us)" << std::setw(12) << "p99(us)" << std::setw(12) << "p999(us)" << std::setw(12) << "max(us)" << '\n';
+  for(int k = 0; k <= KINDS; k++) {
+    std::vector<double> &v = all[k];
+    double max = v.empty() ? 0 : *std::max_element(v.begin(), v.end());
+    std::cout << std::left << std::setw(10) << (k == KINDS ? "total" : KIND_NAMES[k]) << std::right << std::setw(10) << v.size()
+              << std::setw(12) << std::setprecision(0) << v.size() / seconds << std::setprecision(1)
+              << std::setw(12) << percentile(v, 0.5) << std::setw(12) << percentile(v, 0.99)
+              << std::setw(12) << percentile(v, 0.999) << std::setw(12) << max << '\n';
+  }
+  return errors ? 1 : 0;
+}
@@ -30,149 +30,33 @@
 
 #include <iostream>
 #include <limits>
-#include <cassert>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <chrono>
+#include <unistd.h>
+#include <csignal>
 #include "position.hpp"
-#include "TranspositionTable.hpp"
-#include "MoveSorter.hpp"
-
-/*
-// Connect4 Game Solver 메인 로직 커스텀 코드 by 채희재
-//
-// 오리지널 Connect4 Game Solver 의 지향점은 제한된 Depth 기반의 서치가 아닌 풀 서치이다.
-// 2018 인공지능 수업에서 다루었던 단순 미니맥스, 알파베타 프루닝 구현에서 그치지 않고,
-//
-//   중앙일수록 유리하다는 휴리스틱 기반의 트리 탐색 순서 지정을 통해 프루닝 성능 향상,
-//   해시 테이블 기반의 캐쉬를 두어 퍼포먼스 향상,
-//   본인의 다음 수 예측을 통한 프루닝 성능 향상,
-//   비트마스킹을 통한 추가 연산에 따른 추가 소요 시간 최소화
-//   (1~2수를 미리 예측해 프루닝을 하는 것이 프루닝없이 추가적인 탐색을 하는 것보다 효율적)
-//
-// 를 통해 굉장히 오래걸리는 풀 서치를 아주 단시간내에 실현한다.
-// 승리&&패배&&무승부만 체크하는 weak solver로 스코어를 계산할 경우 추가 성능 향상이 가능하나
-// 수 예측을 통한 성능 향상만큼 비약적인 성능 향상이 아닌 아주 미미한 성능 향상이고,
-// <http://connect4.gamesolver.org/> 에서처럼 휴리스틱을 출력하기 위해 strong solver를 사용했다.
-//
-*/
+#include "Solver.hpp"
+#include "OpeningBook.hpp"
+#include "Batch.hpp"
+#include "Ponder.hpp"
+#include "Server.hpp"
 
 using namespace GameSolver::Connect4;
-namespace GameSolver { namespace Connect4 {
-
-  // 보드 7X6 단 한개만 타겟으로 개발한 코드이므로 오리지날 코드에서 불필요한 연산은 상수로 초기화
-  class Solver {
-    private:
-    int columnOrder[Position::WIDTH] = {3, 4, 2, 5, 1, 6, 0};
-    TranspositionTable transTable;
-
-    // 현재까지 둔 수의 모음을 P라고 할 때 다음 착수를 위한 최적의 점수를 구함.
-    int negamax(const Position &P, int alpha, int beta) {
-      assert(alpha < beta);
-      assert(!P.canWinNext());
-
-      // 지지 않는 가능한 수를 마킹한 비트를 구한다.
-      uint64_t next = P.possibleNonLosingMoves();
-
-      // 단 1곳도 없다면, 내 착수를 발판으로 상대가 나를 이긴다.
-      if(next == 0) {
-        return -(Position::WIDTH*Position::HEIGHT - P.nbMoves())/2;
-      }
-
-      // 이미 모든 수 - 2 이상 뒀다면 무승부(바로 윗 조건으로 인해 42번째 수 도달 전에 무승부 여부 파악)
-      if(P.nbMoves() >= Position::WIDTH*Position::HEIGHT - 2) {
-        return 0;
-      }
-
-      // 단순 미니맥스, 알파베타가 아닌 수 예측 기반이므로 알파 & 베타값을 계속해서 조정
-      int min = -(Position::WIDTH*Position::HEIGHT-2 - P.nbMoves())/2;
-      if(alpha < min) {
-        alpha = min;
-        // 프루닝
-        if(alpha >= beta) return alpha;
-      }
-
-      int max = (Position::WIDTH*Position::HEIGHT-1 - P.nbMoves())/2;
-
-      if(int val = transTable.get(P.key())) {
-        max = val + Position::MIN_SCORE - 1;
-      }
-
-      if(beta > max) {
-        beta = max;                     // there is no need to keep beta above our max possible score.
-        // 프루닝
-        if(alpha >= beta) return beta;  // prune the exploration if the [alpha;beta] window is empty.
-      }
-
-      // 단순 탐색이 아닌 포지션 스코어 기반으로 트리 탐색 순서 조정.
-      MoveSorter moves;
-
-      // 데이터 삽입
-      for(int i = Position::WIDTH; i--;) {
-        if(uint64_t move = next & Position::column_mask(columnOrder[i])) {
-          moves.add(move, P.moveScore(move));
-        }
-      }
-
-      // 데이터 추출
-      while(uint64_t next = moves.getNext()) {
-        // 상대방의 착수. 미니맥스 원리로 상대방 스코어의 역수를 사용한다.
-        Position P2(P);
-        P2.play(next);
-        int score = -negamax(P2, -beta, -alpha);
-
-        // 프루닝
-        if(score >= beta) return score;
-        if(score > alpha) alpha = score;
-      }
-
-      // 해싱을 통해 퍼포먼스 향상
-      transTable.put(P.key(), alpha - Position::MIN_SCORE + 1);
-      return alpha;
-    }
-
-    public:
-
-    void reset()
-    {
-      transTable.reset();
-    }
-
-
-    int solve(const Position &P, bool weak = false)
-    {
-      // 리커젼 탈출 조건으로 승리 여부 체크
-      if(P.canWinNext())
-        return (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
-      int min = -(Position::WIDTH*Position::HEIGHT - P.nbMoves())/2;
-      int max = (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
-      if(weak) {
-        min = -1;
-        max = 1;
-      }
-
-      while(min < max) {
-        int med = min + (max - min)/2;
-        if(med <= 0 && min/2 < med) med = min/2;
-        else if(med >= 0 && max/2 > med) med = max/2;
-        int r = negamax(P, med, med + 1);
-        if(r <= med) max = r;
-        else min = r;
-      }
-      return min;
-    }
-
-    // 해싱을 위한 테이블 사이즈를 64MB로 고정. 사이즈는 반드시 소수여야 한다.
-    Solver() : transTable(8388593) {
-      reset();
-    }
-
-  };
-
-}}
 
 
 // Destory AI - 오리지널 코드
 // 기본 게임 구현 및 스타일링, 예외처리 by 채희재
 // 게임 상수 및 변수 초기화
 Solver solver;
+OpeningBook book;
+// 상대방 차례에 솔버의 테이블을 미리 채우는 백그라운드 탐색 (--ponder)
+Ponder ponder(solver);
+bool PONDER = false;
+std::string SERVER_ADDRESS;
 Position P;
 int BOARD_COUNT[8];
 bool ISCIRCLE = true;
@@ -317,8 +201,35 @@ void byHand() {
 // 현 상태에서 중앙부터 차례대로 탐색을 수행하여 스코어를 계산한 뒤, 시각적으로 보여준다.
 //
 
-int temp, max;
+int max;
 int cOrder[7] = {3, 4, 2, 5, 1, 6, 0};
+
+// 오프닝 북에 모든 자식 포지션이 있다면 컬럼별 점수(현재 착수할 플레이어 입장)를 채우고 true 를 리턴한다.
+bool byBook(std::vector<int> &scores) {
+  scores.assign(7, Solver::INVALID_MOVE);
+  for (int col=0; col<7; col++) {
+    if (!P.canPlay(col)) continue;
+    if (P.isWinningMove(col)) {
+      scores[col] = (Position::WIDTH*Position::HEIGHT+1 - P.nbMoves())/2;
+      continue;
+    }
+    Position T(P);
+    T.playCol(col);
+    int score = book.get(T);
+    if (score == OpeningBook::MISSING) return false;
+    scores[col] = -score;
+  }
+  return true;
+}
+
+// 방금 끝난 탐색이 이전 수들의 탐색 결과(테이블)를 얼마나 재사용했는지 출력한다.
+void reportReuse() {
+  const SearchStats &stats = solver.getStats();
+  if (stats.ttHits == 0) return;
+  std::cout << "이전 수의 탐색 결과 재사용 : 테이블 적중 " << stats.ttHits << "회 중 " << stats.ttPreviousHits
+            << "회 (" << int(stats.previousHitRate() * 100 + 0.5) << "%)\n";
+}
+
 void bySearch() {
   std::cout << "\e[92m";
   for (int i=0; i<7; i++) {
@@ -326,22 +237,31 @@ void bySearch() {
     heuristic[i] = 100;
   }
 
+  // 바로 승리하는 수가 있다면 탐색 없이 착수한다.
   for (int col=0; col<7; col++) {
+    if (P.canPlay(cOrder[col]) && P.isWinningMove(cOrder[col])) {
+      std::cout << cOrder[col]+1 << "번 컬럼에 착수하면 바로 승리할 수 있습니다.\n";
+      COL = cOrder[col]+1;
+      return;
+    }
+  }
 
-    if (P.canPlay(cOrder[col])) {
-
-      if (P.isWinningMove(cOrder[col])) {
-        std::cout << cOrder[col]+1 << "번 컬럼에 착수하면 바로 승리할 수 있습니다.\n";
-        COL = cOrder[col]+1;
-        return;
-      }
-
-      // 임시 포지션
-      Position T(P);
-      T.playCol(cOrder[col]);
-
-      temp = solver.solve(T, false);
-      heuristic[cOrder[col]] = temp;
+  // 오프닝 북에 있다면 북의 점수를 사용하고, 없다면 모든 컬럼을 스레드 풀에서 동시에 탐색한다.
+  // heuristic 은 상대방 입장의 점수를 저장하므로 부호를 뒤집는다.
+  std::vector<int> scores;
+  if (byBook(scores)) {
+    std::cout << "오프닝 북의 점수를 사용합니다.\n";
+  } else {
+    scores = solver.analyze(P);
+    reportReuse();
+    // analyze 로 채워진 테이블을 따라 예상 수순을 보여준다.
+    std::cout << "예상 수순 :";
+    for (int col : solver.principalVariation(P)) std::cout << ' ' << col+1;
+    std::cout << '\n';
+  }
+  for (int col=0; col<7; col++) {
+    if (scores[col] != Solver::INVALID_MOVE) {
+      heuristic[col] = -scores[col];
     }
   }
 
@@ -380,6 +300,25 @@ void bySearch() {
 
 }
 
+// 1-1. 시간 제한 탐색
+// --time 으로 지정한 시간 안에 탐색을 끝내고, 그때까지 증명된 최선의 수를 둔다.
+// 시간 안에 점수가 확정되지 않으면 증명된 점수 범위를 함께 보여준다.
+double TIME_LIMIT = 0;
+void bySearchTimed() {
+  std::cout << "\e[92m";
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds((long long)(TIME_LIMIT * 1000));
+  Solver::SearchResult r = solver.solve(P, deadline);
+  reportReuse();
+  COL = r.bestMove + 1;
+  if (r.complete) {
+    std::cout << "\n" << COL << "번 컬럼에 착수합니다. 점수 : " << r.lower << '\n';
+  } else {
+    std::cout << "\n제한 시간 안에 점수를 확정하지 못했습니다. 점수 범위 [" << r.lower << ", " << r.upper << "] 에서 "
+              << COL << "번 컬럼에 착수합니다.\n";
+  }
+  std::cout << "\e[38;5;255m";
+}
+
 // 2. Rule by 문선미, 이태훈, 채희재
 // 초반 5번 수까지는 수가 크게 많지 않으므로 A -> B 이다 형식으로 강제로 착수한다.
 // 6번 수부터는 이러한 케이스가 기하급수적으로 증가하므로 다른 룰을 적용한다.
@@ -728,11 +667,197 @@ bool checkEnd() {
   }
 }
 
+// 실행 인자 처리
+//   -t N, --threads N : 서치에 사용할 스레드 수 (기본 1)
+//   --table FILE      : 시작할 때 FILE 에 저장된 트랜스포지션 테이블을 불러오고, 게임이 끝나면 다시 저장한다.
+//   --book FILE       : C4BookGen 으로 만든 오프닝 북을 사용한다.
+//   --time SECONDS    : 서치 기반 착수 시 한 수에 사용할 최대 시간. 지정하면 초반 5수에도 룰 대신 탐색한다.
+//   --batch [FILE]    : 게임 대신 배치 모드로 실행한다. FILE (없으면 표준입력) 의 착수 순서를 한 줄씩 풀어 출력한다.
+//   --weak            : 배치 모드에서 승/무/패만 계산한다.
+//   --size WxH        : 배치 모드의 보드 크기. 6x5, 7x6 (기본), 8x7, 9x7 중 하나.
+//   --ponder          : 상대방이 수를 고르는 동안 상대방의 모든 응수를 미리 탐색해 둔다.
+//   --server ADDR     : 게임 대신 서버 모드로 실행한다. ADDR 이 숫자면 127.0.0.1 TCP 포트, 아니면 유닉스 소켓 경로.
+//                       -t 는 탐색 워커 수가 된다. 프로토콜은 Server.hpp 참조. 부하 측정은 C4Load.
+//   --cache N         : 서버 모드의 결과 캐시에 저장할 포지션 수 (기본 65536, 0 이면 저장하지 않음)
+//   --table-size MB   : 트랜스포지션 테이블 크기 (64 이상, 2의 거듭제곱으로 내림. 기본 64). 서버 모드에서는 워커마다 이 크기다.
+//   --huge-pages      : 테이블을 huge page 로 할당한다. 예약된 hugetlbfs 페이지가 없으면 transparent huge page 를 요청한다.
+//   --numa            : 테이블 메모리를 모든 NUMA 노드에 번갈아 배치한다. 여러 소켓에 걸친 -t 와 함께 사용한다.
+std::string TABLE_FILE;
+bool BATCH = false;
+bool WEAK = false;
+std::string BATCH_FILE;
+int BATCH_WIDTH = Position::WIDTH;
+int BATCH_HEIGHT = Position::HEIGHT;
+size_t CACHE_SIZE = Server::DEFAULT_CACHE_SIZE;
+int TABLE_LOG = 0;              // 테이블 버킷 수의 log2 (0 이면 기본 크기)
+unsigned int TABLE_FLAGS = 0;   // Solver::Table::HUGETLB_PAGES, INTERLEAVE
+void parseArgs(int argc, char** argv) {
+  for (int i=1; i<argc; i++) {
+    if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && i+1 < argc) {
+      int n = atoi(argv[++i]);
+      solver.setThreads(n > 0 ? n : 1);
+    } else if (!strcmp(argv[i], "--table") && i+1 < argc) {
+      TABLE_FILE = argv[++i];
+    } else if (!strcmp(argv[i], "--batch")) {
+      BATCH = true;
+      if (i+1 < argc && argv[i+1][0] != '-') BATCH_FILE = argv[++i];
+    } else if (!strcmp(argv[i], "--weak")) {
+      WEAK = true;
+    } else if (!strcmp(argv[i], "--ponder")) {
+      PONDER = true;
+    } else if (!strcmp(argv[i], "--server") && i+1 < argc) {
+      SERVER_ADDRESS = argv[++i];
+    } else if (!strcmp(argv[i], "--cache") && i+1 < argc) {
+      CACHE_SIZE = strtoull(argv[++i], 0, 10);
+    } else if (!strcmp(argv[i], "--table-size") && i+1 < argc) {
+      // 버킷은 64바이트이므로 1MB 는 버킷 2^14 개
+      unsigned long long mb = strtoull(argv[++i], 0, 10);
+      TABLE_LOG = 14;
+      while (mb >= 2) mb >>= 1, TABLE_LOG++;
+      if (TABLE_LOG < Solver::TABLE_LOG_SIZE) {
+        std::cerr << argv[i] << " : 테이블 크기는 64MB 이상이어야 합니다.\n";
+        exit(1);
+      }
+    } else if (!strcmp(argv[i], "--huge-pages")) {
+      TABLE_FLAGS |= Solver::Table::HUGETLB_PAGES;
+    } else if (!strcmp(argv[i], "--numa")) {
+      TABLE_FLAGS |= Solver::Table::INTERLEAVE;
+    } else if (!strcmp(argv[i], "--size") && i+1 < argc) {
+      if (sscanf(argv[++i], "%dx%d", &BATCH_WIDTH, &BATCH_HEIGHT) != 2) {
+        std::cerr << argv[i] << " 은 올바른 보드 크기가 아닙니다. (예 7x6)\n";
+        exit(1);
+      }
+    } else if (!strcmp(argv[i], "--time") && i+1 < argc) {
+      TIME_LIMIT = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--book") && i+1 < argc) {
+      if (!book.open(argv[++i])) {
+        std::cerr << argv[i] << " 은 올바른 오프닝 북 파일이 아닙니다.\n";
+        exit(1);
+      }
+    } else {
+      std::cerr << "사용법 : " << argv[0] << " [-t 스레드수] [--table 파일] [--book 파일] [--time 초] [--ponder] [--batch [파일] [--weak] [--size WxH]] [--server 주소 [--cache 포지션수]]\n"
+                << "       [--table-size MB] [--huge-pages] [--numa]\n";
+      exit(1);
+    }
+  }
+}
+
+// --table-size, --huge-pages, --numa 가 있으면 테이블을 다시 할당한다.
+template<class S>
+void sizeTable(S &solver) {
+  if (TABLE_LOG == 0 && TABLE_FLAGS == 0) return;
+  int log = TABLE_LOG ? TABLE_LOG : S::TABLE_LOG_SIZE;
+  if (!solver.setTableSize(log, TABLE_FLAGS)) {
+    std::cerr << "\e[38;5;196m" << (64ULL << (log - 20)) << "MB 테이블을 할당하지 못해 기본 크기를 사용합니다.\e[38;5;255m\n";
+    return;
+  }
+  std::cerr << "트랜스포지션 테이블 " << (64ULL << (log - 20)) << "MB (페이지 : " << solver.getTablePages()
+            << (solver.isTableInterleaved() ? ", NUMA 인터리브" : "") << ")\n";
+}
+
+// 이전 게임에서 저장한 테이블이 있다면 불러온다.
+template<class S>
+void loadTable(S &solver) {
+  if (TABLE_FILE.empty() || access(TABLE_FILE.c_str(), F_OK) != 0) return;
+  if (solver.loadTable(TABLE_FILE)) {
+    std::cerr << "저장된 트랜스포지션 테이블을 불러왔습니다. (" << TABLE_FILE << ")\n";
+  } else {
+    std::cerr << "\e[38;5;196m" << TABLE_FILE << " 은 보드 크기나 형식이 맞지 않아 불러오지 않았습니다.\e[38;5;255m\n";
+  }
+}
+
+// 게임이 끝나면 테이블을 저장해 다음 실행에서 이어서 사용한다.
+template<class S>
+void saveTable(S &solver) {
+  if (TABLE_FILE.empty()) return;
+  if (!solver.saveTable(TABLE_FILE)) {
+    std::cerr << "\e[38;5;196m트랜스포지션 테이블을 저장하지 못했습니다. (" << TABLE_FILE << ")\e[38;5;255m\n";
+  }
+}
+
+// 배치 모드. 터미널 출력(보드, 색상) 없이 결과만 출력한다.
+template<class S>
+int runBatch(S &solver) {
+  std::ios::sync_with_stdio(false);
+  sizeTable(solver);
+  loadTable(solver);
+  BasicBatch<S> batch(solver, WEAK);
+  if (BATCH_FILE.empty()) {
+    batch.run(std::cin, std::cout);
+  } else {
+    std::ifstream in(BATCH_FILE.c_str());
+    if (!in) {
+      std::cerr << BATCH_FILE << " 을 열 수 없습니다.\n";
+      return 1;
+    }
+    batch.run(in, std::cout);
+  }
+  saveTable(solver);
+  return 0;
+}
+
+// 7X6 이 아닌 보드의 배치 모드. 해당 크기의 솔버를 만들어 스레드 수를 이어받는다.
+template<int W, int H>
+int runBatchSized() {
+  std::unique_ptr<BasicSolver<W, H> > sized(new BasicSolver<W, H>());
+  sized->setThreads(solver.getThreads());
+  return runBatch(*sized);
+}
+
+// --size 로 고른 보드 크기의 배치 모드. 보드 크기마다 따로 컴파일된 솔버를 사용한다.
+int runBatch() {
+  if (BATCH_WIDTH == 7 && BATCH_HEIGHT == 6) return runBatch(solver);
+  if (BATCH_WIDTH == 6 && BATCH_HEIGHT == 5) return runBatchSized<6, 5>();
+  if (BATCH_WIDTH == 8 && BATCH_HEIGHT == 7) return runBatchSized<8, 7>();
+#ifdef POSITION_WIDE_BOARDS
+  // 64칸을 넘는 보드는 128비트 비트보드를 사용한다.
+  if (BATCH_WIDTH == 9 && BATCH_HEIGHT == 7) return runBatchSized<9, 7>();
+#endif
+  std::cerr << BATCH_WIDTH << "x" << BATCH_HEIGHT << " 보드는 지원하지 않습니다. (6x5, 7x6, 8x7, 9x7)\n";
+  return 1;
+}
+
+// 서버 모드. SIGINT/SIGTERM 을 받으면 진행 중인 요청을 정리하고 끝낸다.
+Server *SERVER = 0;
+void stopServer(int) {
+  if (SERVER) SERVER->stop();
+}
+
+int runServer() {
+  Server server(solver.getThreads(), CACHE_SIZE);
+  if (TABLE_LOG || TABLE_FLAGS) server.setTableSize(TABLE_LOG ? TABLE_LOG : Solver::TABLE_LOG_SIZE, TABLE_FLAGS);
+  std::string error;
+  if (!server.listen(SERVER_ADDRESS, error)) {
+    std::cerr << SERVER_ADDRESS << " 에서 서버를 시작할 수 없습니다. (" << error << ")\n";
+    return 1;
+  }
+  SERVER = &server;
+  signal(SIGINT, stopServer);
+  signal(SIGTERM, stopServer);
+  std::cerr << SERVER_ADDRESS << " 에서 요청을 기다립니다. (워커 " << solver.getThreads() << "개)\n";
+  server.run();
+  SERVER = 0;
+  std::cerr << "서버를 종료합니다. 처리한 요청 " << server.requestCount() << "개\n";
+  const ResultCache &cache = server.resultCache();
+  std::cerr << "결과 캐시 : 적중 " << cache.hitCount() << "회, 실패 " << cache.missCount() << "회 (그중 계산 중인 요청과 합침 "
+            << cache.coalescedCount() << "회), 축출 " << cache.evictionCount() << "회\n";
+  return 0;
+}
+
 // 메인 프로그램 구현 by 채희재
-int main() {
+int main(int argc, char** argv) {
+  parseArgs(argc, argv);
+  if (BATCH) {
+    return runBatch();
+  }
+  if (!SERVER_ADDRESS.empty()) {
+    return runServer();
+  }
   std::cout << "\e[38;5;255m";
   std::cout << "\n\e[38;5;198mDestroy AI - Connect4 Solver\e[38;5;255m\n";
   std::cout << "                             by \e[38;5;117m채희재 이태훈 문선미\e[38;5;255m\n\n";
+  sizeTable(solver);
+  loadTable(solver);
   initBoard();
   askFirst();
 
@@ -748,8 +873,16 @@ int main() {
 
     askMethod();
     if (METHOD == 1) {
+      // 이전 수들의 테이블을 이어서 사용한다. 세대를 올리고, 현재 포지션에서 도달할 수 없는 엔트리는 지운다.
+      // 저장할 테이블 파일(--table)이 있다면 다음 게임에서 쓸 초반 엔트리를 남기기 위해 지우지 않는다.
+      solver.beginMove(P, TABLE_FILE.empty());
       // 서치 기반. 단 5수까지는 룰을 사용해 빠르게 착수.
-      if (P.nbMoves() < 5) {
+      // 오프닝 북에 현재 포지션의 자식들이 모두 있다면 룰 대신 북을 사용한다.
+      // 시간 제한(--time)이 있다면 룰 대신 시간 제한 탐색으로 몇 번째 수이든 제한 시간 안에 착수한다.
+      std::vector<int> scores;
+      if (TIME_LIMIT > 0 && !byBook(scores)) {
+        bySearchTimed();
+      } else if (P.nbMoves() < 5 && !byBook(scores)) {
         std::cout << "5수까지는 시간제약을 지키기 위해 Rule을 사용해 이상적인 수를 둡니다.\n";
         byRule();
       } else {
@@ -773,8 +906,14 @@ int main() {
     }
 
     // 수동 착수
+    // 상대방이 고민하는 동안 가능한 응수를 모두 미리 탐색하고, 착수하면 바로 멈춘다.
     draw();
+    if (PONDER) ponder.start(P);
     byHand();
+    if (PONDER) {
+      ponder.stop();
+      if (ponder.isSolved(COL-1)) std::cout << "\e[92m" << COL << "번 컬럼의 응수는 미리 탐색해 두었습니다.\e[38;5;255m\n";
+    }
 
     // 승리 여부 체크
     if (checkEnd()) {
@@ -787,4 +926,5 @@ int main() {
       break;
     }
   }
+  saveTable(solver);
 }
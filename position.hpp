@@ -33,26 +33,102 @@
 
 #include <string>
 #include <cstdint>
+#include <cassert>
 #include <iostream>
+#include <type_traits>
+
+// 비트 연산이 몰려 있는 탐색 함수에 붙이는 함수 다중 버전(function multiversioning) 속성.
+// x86-64 리눅스의 GCC 에서는 POPCNT 용과 기본 복제본을 함께 만들고 프로그램 시작 시 CPU 에 맞는 것을 골라 쓴다.
+// 따라서 -march 없이 빌드한 바이너리 하나가 어디서나 돌면서, 지원하는 CPU 에서는 popcount 가 명령어 하나가 된다.
+// "arch=haswell" 복제본은 만들지 않는다. GCC 는 arch 가 다른 복제본 안으로 보통 함수를 인라인하지 않아서
+// possibleNonLosingMoves(), 테이블 get()/put() 등이 모두 함수 호출이 되고 오히려 느려진다.
+// 복제본 안에서 쓰는 비트 연산 함수에는 POSITION_INLINE 을 붙여 해당 복제본의 명령어 집합으로 컴파일되게 한다.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6 && defined(__x86_64__) && defined(__linux__)
+#define POSITION_MULTIVERSION __attribute__((target_clones("popcnt", "default")))
+#else
+#define POSITION_MULTIVERSION
+#endif
+
+#ifdef __GNUC__
+#define POSITION_INLINE __attribute__((always_inline))
+#else
+#define POSITION_INLINE
+#endif
 
 namespace GameSolver { namespace Connect4 {
 
+#ifdef __SIZEOF_INT128__
+  // 64칸을 넘는 보드(8X8, 9X7 등)의 비트보드. GCC/Clang 의 64비트 타깃에서 지원한다.
+  typedef unsigned __int128 uint128_t;
+#define POSITION_WIDE_BOARDS 1
+#endif
+
+  // 보드 크기에 맞는 비트보드 타입. W x (H+1) 비트가 64비트에 들어가면 uint64_t,
+  // 아니면 uint128_t 를 사용한다. 7X6 을 비롯한 64비트 보드는 기존과 같은 코드로 컴파일된다.
+  template<int W, int H>
+  struct Bitboard {
+#ifdef POSITION_WIDE_BOARDS
+    typedef typename std::conditional<W*(H+1) <= 64, uint64_t, uint128_t>::type type;
+#else
+    typedef uint64_t type;
+#endif
+  };
+
+  // 비트보드의 1 의 개수와 최하위 1 의 위치.
+  // 128비트 비트보드는 64비트 두 개로 나누어 같은 명령어로 계산한다.
+  inline POSITION_INLINE unsigned int bitCount(uint64_t b) {
+    return __builtin_popcountll(b);
+  }
+
+  inline POSITION_INLINE int lowestBit(uint64_t b) {
+    return __builtin_ctzll(b);
+  }
+
+#ifdef POSITION_WIDE_BOARDS
+  inline POSITION_INLINE unsigned int bitCount(uint128_t b) {
+    return __builtin_popcountll(uint64_t(b)) + __builtin_popcountll(uint64_t(b >> 64));
+  }
+
+  inline POSITION_INLINE int lowestBit(uint128_t b) {
+    return uint64_t(b) ? __builtin_ctzll(uint64_t(b)) : 64 + __builtin_ctzll(uint64_t(b >> 64));
+  }
+#endif
+
   // 보드의 맨 아랫줄을 1로 다 채운 것.
-  constexpr static uint64_t bottom(int width, int height) {
-    return width == 0 ? 0 : bottom(width-1, height) | 1LL << (width-1)*(height+1);
+  template<class B>
+  constexpr B bottom(int width, int height) {
+    return width == 0 ? 0 : bottom<B>(width-1, height) | B(1) << (width-1)*(height+1);
   }
 
-  class Position {
+  // 보드 크기(W x H)를 템플릿 인자로 받는 포지션.
+  // 마스크와 쉬프트 크기가 모두 컴파일 시점 상수가 되므로, 보드 크기마다 분기 없이 펼쳐진 코드가 만들어진다.
+  // 게임과 오프닝 북은 7X6 인 Position 을 사용하고, 다른 크기는 배치 모드(--size)에서 사용한다.
+  template<int W, int H>
+  class BasicPosition {
     public:
 
       // 보드 및 알파 베타 프루닝을 위한 기본 상수
       // 스코어 계산법에 대한 자세한 내용은 보고서 참조.
-      static const int WIDTH = 7;
-      static const int HEIGHT = 6;
+      static const int WIDTH = W;
+      static const int HEIGHT = H;
       static const int MIN_SCORE = -(WIDTH*HEIGHT)/2 + 3;
       static const int MAX_SCORE = (WIDTH*HEIGHT+1)/2 - 3;
+      static_assert(WIDTH >= 4 && HEIGHT >= 4, "Board must be at least 4x4");
       static_assert(WIDTH < 10, "Board's width must be less than 10");
+#ifdef POSITION_WIDE_BOARDS
+      static_assert(WIDTH*(HEIGHT+1) <= 128, "Board does not fit in 128bits bitboard");
+#else
       static_assert(WIDTH*(HEIGHT+1) <= 64, "Board does not fit in 64bits bitboard");
+#endif
+
+      // 비트보드 타입. 64칸 이하의 보드는 uint64_t, 더 큰 보드는 uint128_t.
+      typedef typename Bitboard<W, H>::type bitboard_t;
+
+      // 중앙에서 바깥쪽으로 가는 컬럼 탐색 순서의 i 번째 컬럼.
+      // ex) 7X6 : 3, 4, 2, 5, 1, 6, 0 / 6X5 : 2, 3, 1, 4, 0, 5
+      static constexpr int centerColumn(int i) {
+        return (WIDTH-1)/2 + (2*(i%2)-1)*(i+1)/2;
+      }
 
       // 최상위 컬럼의 비트와 마스크(지금까지 둔 곳)의 &연산을 했을 때 1이라면 최상위 컬럼이 채워진 것 => 진행 불가.
       // 0 이라면 아직 채워지지 않았으므로 진행 가능.
@@ -65,7 +141,7 @@ namespace GameSolver { namespace Connect4 {
       // 실제로 착수한다. (moves 1 증가)
       // current_position 에는 착수된 곳 중 O/X 가 번갈아서 1/0이 된다.
       // mask는 O/X 구분하지 않고 착수된 곳이 모두 1이 된다.
-      void play(uint64_t move)
+      void play(bitboard_t move)
       {
         current_position ^= mask;
         mask |= move;
@@ -80,7 +156,19 @@ namespace GameSolver { namespace Connect4 {
         play((mask + bottom_mask_col(col)) & column_mask(col));
       }
 
-      // 오리지널 코드에서 불필요한 코드(벤치마크용)는 삭제하였다.
+      // 착수 순서를 나타내는 문자열(1~7 컬럼 번호, 예 "4453")대로 착수한다.
+      // 오리지널 코드의 벤치마크용 함수를 벤치마크/배치 처리를 위해 다시 추가하였다.
+      // 중간에 잘못된 컬럼, 꽉 찬 컬럼, 바로 승리하는 수를 만나면 멈추고
+      // 그때까지 착수한 수의 개수를 리턴한다.
+      unsigned int play(const std::string &seq)
+      {
+        for(unsigned int i = 0; i < seq.size(); i++) {
+          int col = seq[i] - '1';
+          if(col < 0 || col >= WIDTH || !canPlay(col) || isWinningMove(col)) return i;
+          playCol(col);
+        }
+        return seq.size();
+      }
 
       // 다음 착수로 승리할 수 있는지 체크한다.
       bool canWinNext() const
@@ -97,11 +185,49 @@ namespace GameSolver { namespace Connect4 {
       // 현재 포지션을 대표하는 독립적인 키를 리턴한다.
       // 캐쉬 작업에 사용된다.
       // key = current_position + mask
-      uint64_t key() const
+      bitboard_t key() const
       {
         return current_position + mask;
       }
 
+      // 좌우 대칭(컬럼 순서를 뒤집은) 포지션을 리턴한다.
+      // 좌우 대칭인 두 포지션은 점수가 같다.
+      BasicPosition mirror() const
+      {
+        BasicPosition M;
+        M.current_position = mirror_bitmap(current_position);
+        M.mask = mirror_bitmap(mask);
+        M.moves = moves;
+        return M;
+      }
+
+      // 착수 비트(한 비트만 켜진 값)가 속한 컬럼.
+      // 최하위 비트 위치는 bsf 명령어 하나로 구한다.
+      POSITION_INLINE static int moveColumn(bitboard_t move) {
+        return lowestBit(move) / (HEIGHT+1);
+      }
+
+      // 좌우 대칭인 두 포지션의 키 중 작은 것.
+      // 대칭 포지션이 테이블/오프닝 북에서 같은 자리를 사용하게 된다.
+      // 키는 컬럼마다 (HEIGHT+1) 비트 안에서 더해지고 다른 컬럼으로 올림이 넘어가지 않으므로
+      // 키의 컬럼 순서를 뒤집으면 그대로 대칭 포지션의 키가 된다.
+      bitboard_t canonicalKey() const
+      {
+        bitboard_t k = key();
+        bitboard_t m = mirror_bitmap(k);
+        return m < k ? m : k;
+      }
+
+      // canonicalKey() 와 같고, 대칭 포지션의 키를 골랐다면 mirrored 를 true 로 한다.
+      // 테이블에 컬럼을 저장할 때 좌우를 뒤집어야 하는지 알기 위해 사용한다.
+      bitboard_t canonicalKey(bool &mirrored) const
+      {
+        bitboard_t k = key();
+        bitboard_t m = mirror_bitmap(k);
+        mirrored = m < k;
+        return mirrored ? m : k;
+      }
+
       // 해당 컬럼을 착수했을 때 승리하는 지 여부를 결과로 리턴
       // 다른 곳에서도 쓸 수 있게끔 public으로 구현.
       //   해당 컬럼에
@@ -117,14 +243,14 @@ namespace GameSolver { namespace Connect4 {
       // 지금 당장 착수해도 아무런 문제가 없는, 즉 지지 않는 착수들을 모두 고려하여 1로 마킹한
       // 비트를 리턴한다.
       // 수를 예측하여 프루닝을 향상시키는 데 사용되며 성능을 비약적으로 향상시킨다.
-      uint64_t possibleNonLosingMoves() const {
+      POSITION_INLINE bitboard_t possibleNonLosingMoves() const {
         assert(!canWinNext());
         // 착수 가능한 곳 마킹
-        uint64_t possible_mask = possible();
+        bitboard_t possible_mask = possible();
         // 상대방이 착수 시 이기는 곳 마킹
-        uint64_t opponent_win = opponent_winning_position();
+        bitboard_t opponent_win = opponent_winning_position();
         // 내가 둘 수 있는 데 두지 않을 경우, 상대가 두어서 승리하므로, 해당 위치는 강제하여 착수한다.
-        uint64_t forced_moves = possible_mask & opponent_win;
+        bitboard_t forced_moves = possible_mask & opponent_win;
 
         // 그러한 강제 착수 위치가 존재한다면,
         if(forced_moves) {
@@ -140,12 +266,12 @@ namespace GameSolver { namespace Connect4 {
 
       // 승리가능한 포인트를 마킹하여 카운트한 것을 moveScore라는 점수로 계산한다.
       // 승리 포인트가 많다는 것은 그만큼 이길 확률이 높다는 의미와 같다.
-      int moveScore(uint64_t move) const {
+      POSITION_INLINE int moveScore(bitboard_t move) const {
         return popcount(compute_winning_position(current_position | move, mask));
       }
 
       // 현재 포지션 기준 상대방 입장에서 승리 가능한 포지션을 비트로 리턴.
-      uint64_t opponent_winning_position() const {
+      bitboard_t opponent_winning_position() const {
         return compute_winning_position(current_position ^ mask, mask);
       }
 
@@ -159,37 +285,51 @@ namespace GameSolver { namespace Connect4 {
       // 0010000   // 0000101
       // 0010101   // 0100010
       // 0110111   // 1001000
-      uint64_t possible() const {
+      bitboard_t possible() const {
         return (mask + bottom_mask) & board_mask;
       }
 
+      // 대량 평가(BulkEval)에 넘길 비트보드. 현재 착수할 플레이어의 돌과 전체 착수 위치.
+      bitboard_t positionBits() const
+      {
+        return current_position;
+      }
+
+      bitboard_t maskBits() const
+      {
+        return mask;
+      }
+
       // 생성자.
       // 오리지널 코드에서 수행하던 불필요한 초기화 연산은 삭제하고 상수로 초기화 하였다.
-      Position() : current_position{0}, mask{0}, moves{0} {}
+      BasicPosition() : current_position{0}, mask{0}, moves{0} {}
 
     private:
+      // compute_winning_position 과 같은 계산을 여러 포지션에 대해 벡터로 수행한다.
+      friend class BulkEval;
+
       // 착수와 관련된 변수
       // 비트맵으로 선공/후공을 구분하고,
       // 돌이 놓여져 있는 곳을 마스킹한다.
       // 그리고 현재까지 총 몇수가 진행되었는지도 관리한다.
-      uint64_t current_position;
-      uint64_t mask;
+      bitboard_t current_position;
+      bitboard_t mask;
       unsigned int moves;
 
       // 현재 O/X가 누구인지, 어디까지 착수되었는지를 기반으로 승리 가능한 포지션을 비트로 리턴.
-      uint64_t winning_position() const {
+      bitboard_t winning_position() const {
         return compute_winning_position(current_position, mask);
       }
 
       // 주어진 비트 속에서 1을 전부 센다.
-      static unsigned int popcount(uint64_t m) {
-        unsigned int c = 0;
-        for (c = 0; m; c++) m &= m - 1;
-        return c;
+      // POPCNT 를 지원하는 복제본(POSITION_MULTIVERSION)에서는 popcnt 명령어 하나가 되고,
+      // 기본 복제본에서는 컴파일러 내장 구현을 사용한다. 128비트 비트보드는 popcnt 두 번이 된다.
+      POSITION_INLINE static unsigned int popcount(bitboard_t m) {
+        return bitCount(m);
       }
 
       // 현재 착수하는 사람의 포지션과 마스크를 기반으로, 다음 착수 중 승리하게 되는 위치를 계산한다.
-      static uint64_t compute_winning_position(uint64_t position, uint64_t mask) {
+      POSITION_INLINE static bitboard_t compute_winning_position(bitboard_t position, bitboard_t mask) {
         // 수직 연속 3개 여부 확인
         // 수직 연속 3개라면 쉬프트를 1, 2, 3한 뒤 & 연산 시 겹치는 곳이 나온다.
         // 0 0 0
@@ -199,7 +339,7 @@ namespace GameSolver { namespace Connect4 {
         // 1 1 1 <- r
         // 1 1 0
         // 1 0 0
-        uint64_t r = (position << 1) & (position << 2) & (position << 3);
+        bitboard_t r = (position << 1) & (position << 2) & (position << 3);
 
         // 수평 연속 3개 혹은 1개-빈칸-2개 여부 확인
         // 0 1 1 1 0
@@ -212,7 +352,7 @@ namespace GameSolver { namespace Connect4 {
         //     0 1 1   1 0
         //       | 여기
 
-        uint64_t p = (position << (HEIGHT+1)) & (position << 2*(HEIGHT+1));
+        bitboard_t p = (position << (HEIGHT+1)) & (position << 2*(HEIGHT+1));
         r |= p & (position << 3*(HEIGHT+1));
         r |= p & (position >> (HEIGHT+1));
         p = (position >> (HEIGHT+1)) & (position >> 2*(HEIGHT+1));
@@ -259,10 +399,10 @@ namespace GameSolver { namespace Connect4 {
       // 1111111
       // 1111111
       // 1111111
-      const static uint64_t bottom_mask = bottom(WIDTH, HEIGHT);
+      static constexpr bitboard_t bottom_mask = bottom<bitboard_t>(WIDTH, HEIGHT);
 
       // 보드 마스크(7번째 줄을 제외한 실제 게임이 이뤄지는 보드만 마스킹한 것)
-      const static uint64_t board_mask = bottom_mask * ((1LL << HEIGHT)-1);
+      static constexpr bitboard_t board_mask = bottom_mask * ((bitboard_t(1) << HEIGHT)-1);
 
       // col 에 해당하는 컬럼의 맨 위에 1 한개를 채운 것.
       // ex) top_mask_col(1)
@@ -273,8 +413,8 @@ namespace GameSolver { namespace Connect4 {
       // 0000000
       // 0000000
       // 0000000
-      static constexpr uint64_t top_mask_col(int col) {
-        return UINT64_C(1) << ((HEIGHT - 1) + col*(HEIGHT+1));
+      static constexpr bitboard_t top_mask_col(int col) {
+        return bitboard_t(1) << ((HEIGHT - 1) + col*(HEIGHT+1));
       }
 
       // col 에 해당하는 컬럼의 맨 아래에 1 한개를 채운 것.
@@ -286,8 +426,17 @@ namespace GameSolver { namespace Connect4 {
       // 0000000
       // 0000000
       // 0000000
-      static constexpr uint64_t bottom_mask_col(int col) {
-        return UINT64_C(1) << col*(HEIGHT+1);
+      static constexpr bitboard_t bottom_mask_col(int col) {
+        return bitboard_t(1) << col*(HEIGHT+1);
+      }
+
+      // 비트보드의 컬럼 순서를 뒤집는다. (HEIGHT+1 비트 단위, 맨 위 여분 비트 포함)
+      // 컴파일 시점에 펼쳐져 컬럼마다 AND, 쉬프트, OR 한 번씩으로 계산된다.
+      // ex) 7X6 에서 0번 컬럼 <-> 6번 컬럼, 1번 <-> 5번, 2번 <-> 4번, 3번은 그대로
+      static constexpr bitboard_t mirror_bitmap(bitboard_t b, int col = 0) {
+        return col >= WIDTH ? 0 :
+          ((b >> col*(HEIGHT+1) & ((bitboard_t(1) << (HEIGHT+1))-1)) << (WIDTH-1-col)*(HEIGHT+1))
+          | mirror_bitmap(b, col+1);
       }
 
     public:
@@ -300,12 +449,35 @@ namespace GameSolver { namespace Connect4 {
       // 0100000
       // 0100000
       // 0100000
-      static constexpr uint64_t column_mask(int col) {
-        return ((UINT64_C(1) << HEIGHT)-1) << col*(HEIGHT+1);
+      static constexpr bitboard_t column_mask(int col) {
+        return ((bitboard_t(1) << HEIGHT)-1) << col*(HEIGHT+1);
       }
 
   };
 
+  // 클래스 안에서 초기화한 정적 상수의 정의. 참조로 넘겨질 때(odr-use) 필요하다.
+  template<int W, int H> const int BasicPosition<W, H>::WIDTH;
+  template<int W, int H> const int BasicPosition<W, H>::HEIGHT;
+  template<int W, int H> const int BasicPosition<W, H>::MIN_SCORE;
+  template<int W, int H> const int BasicPosition<W, H>::MAX_SCORE;
+  template<int W, int H> constexpr typename BasicPosition<W, H>::bitboard_t BasicPosition<W, H>::bottom_mask;
+  template<int W, int H> constexpr typename BasicPosition<W, H>::bitboard_t BasicPosition<W, H>::board_mask;
+
+  // 대회 규격 보드
+  typedef BasicPosition<7, 6> Position;
+
+  // 0 .. N-1 정수 목록. C++11 에는 std::index_sequence 가 없어서 직접 만든다.
+  template<int... I> struct Indices {};
+  template<int N, int... I> struct MakeIndices : MakeIndices<N-1, N-1, I...> {};
+  template<int... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+  // 포지션 P 의 중앙 우선 컬럼 순서를 컴파일 시점에 만든 배열. CenterOrder<P>::columns
+  template<class P, class = typename MakeIndices<P::WIDTH>::type> struct CenterOrder;
+  template<class P, int... I> struct CenterOrder<P, Indices<I...> > {
+    static constexpr int columns[sizeof...(I)] = {P::centerColumn(I)...};
+  };
+  template<class P, int... I> constexpr int CenterOrder<P, Indices<I...> >::columns[sizeof...(I)];
+
 }} // end namespaces
 
 #endif